@@ -0,0 +1,20 @@
+#  FindLZ4.cmake
+#  LZ4_FOUND
+#  LZ4_INCLUDE_DIRS
+#  LZ4_LIBRARY
+
+find_path(LZ4_INCLUDE_DIRS
+	NAMES lz4.h
+	PATH_SUFFIXES include
+)
+
+find_library(LZ4_LIBRARY
+	NAMES lz4 liblz4
+	PATH_SUFFIXES bin lib
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4
+	FOUND_VAR LZ4_FOUND
+	REQUIRED_VARS LZ4_LIBRARY LZ4_INCLUDE_DIRS
+)
@@ -0,0 +1,41 @@
+#pragma once
+
+// qt includes
+#include <QObject>
+#include <QRunnable>
+#include <QByteArray>
+
+// hyperion includes
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+///
+/// @brief JPEG encodes a single image of the live image stream in the global thread pool.
+/// The result is delivered with imageEncoded(), the connection to a receiver that has been deleted meanwhile is removed by Qt.
+///
+class ImageStreamEncoder : public QObject, public QRunnable
+{
+	Q_OBJECT
+
+public:
+	///
+	/// @param image     The image to encode (shared, not copied)
+	/// @param maxWidth  Downscale wider images to this width keeping the aspect ratio, 0 to keep the size
+	///
+	ImageStreamEncoder(const Image<ColorRgb>& image, int maxWidth);
+
+	void run() override;
+
+signals:
+	///
+	/// @brief Emits with the encoded image
+	/// @param jpeg    The JPEG data
+	/// @param width   The width of the encoded image
+	/// @param height  The height of the encoded image
+	///
+	void imageEncoded(const QByteArray& jpeg, int width, int height);
+
+private:
+	const Image<ColorRgb> _image;
+	const int _maxWidth;
+};
@@ -88,12 +88,30 @@ private slots:
 	///
 	void handleInstanceStateChange(InstanceState state, quint8 instance, const QString &name = QString());
 
+	///
+	/// @brief Handle a JPEG encoded image of the image stream (encoded in the thread pool)
+	/// @param jpeg    The JPEG data
+	/// @param width   The width of the encoded image
+	/// @param height  The height of the encoded image
+	///
+	void handleEncodedImage(const QByteArray &jpeg, int width, int height);
+
 signals:
 	///
 	/// Signal emits with the reply message provided with handleMessage()
 	///
 	void callbackMessage(QJsonObject);
 
+	///
+	/// Signal emits with binary stream messages (ledcolors/imagestream with format "binary"), just supported by WebSocket clients
+	///
+	/// LED frame (full):  [0x01][u16 ledCount][rgb * ledCount]
+	/// LED frame (delta): [0x02][u16 ledCount] followed by runs of [u16 unchangedLeds][u16 changedLeds][rgb * changedLeds]
+	/// Image:             [0x03][u16 width][u16 height][JPEG data]
+	/// All integers are big endian
+	///
+	void callbackBinaryMessage(const QByteArray &data);
+
 	///
 	/// Signal emits whenever a JSON-message should be forwarded
 	///
@@ -126,6 +144,26 @@ private:
 	/// the current streaming led values
 	std::vector<ColorRgb> _currentLedValues;
 
+	/// true if the led stream is sent as binary delta frames
+	bool _ledStreamBinary;
+
+	/// the led values of the last binary frame, base of the next delta
+	std::vector<ColorRgb> _previousStreamLedValues;
+
+	/// image stream state
+	bool _imageStreamActive;
+	bool _imageStreamBinary;
+	bool _imageEncodePending;
+	qint64 _imageStreamInterval;
+	qint64 _lastImageStreamTime;
+
+	///
+	/// @brief Encode the led values as full or delta binary frame against the previously sent frame
+	/// @param ledColors  The current led colors
+	/// @param[out] data  The binary frame, empty if nothing changed
+	///
+	void encodeLedFrame(const std::vector<ColorRgb> &ledColors, QByteArray &data);
+
 	///
 	/// @brief Handle the switches of Hyperion instances
 	/// @param instance the instance to switch
@@ -284,6 +322,12 @@ private:
 	///
 	void handleInputSourceCommand(const QJsonObject& message, const QString& command, int tan);
 
+	/// Handle an incoming JSON Tracing message
+	///
+	/// @param message the incoming message
+	///
+	void handleTracingCommand(const QJsonObject &message, const QString &command, int tan);
+
 	///
 	/// Handle an incoming JSON message of unknown type
 	///
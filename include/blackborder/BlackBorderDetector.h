@@ -1,6 +1,10 @@
 //#include <iostream>
 #pragma once
 
+// STL includes
+#include <algorithm>
+#include <vector>
+
 // Utils includes
 #include <utils/Image.h>
 
@@ -278,8 +282,187 @@ namespace hyperion
 
 
 
+		///
+		/// fullscan detection mode (whole rows and columns of all 4 sides)
+		/// The image is sampled into a plane of the brightest channel per pixel, decimated to at most
+		/// FULLSCAN_PLANE_SIZE samples per side (already decimated images are used as they are). Rows and columns
+		/// of the plane are compared against the threshold with SIMD, from every side inwards. The borders found
+		/// are refined at image resolution.
+		template <typename Pixel_T>
+		BlackBorder process_fullscan(const Image<Pixel_T> & image)
+		{
+			BlackBorder detectedBorder;
+			detectedBorder.unknown = true;
+			detectedBorder.horizontalSize = -1;
+			detectedBorder.verticalSize = -1;
+
+			const int width = image.width();
+			const int height = image.height();
+			if (width == 0 || height == 0)
+			{
+				return detectedBorder;
+			}
+
+			// brightest channel of every step-th pixel, black exactly if it is below the threshold
+			const int step = std::max(1, std::max(width, height) / FULLSCAN_PLANE_SIZE);
+			resizePlane((width + step - 1) / step, (height + step - 1) / step);
+			for (int row = 0; row < _planeHeight; ++row)
+			{
+				const Pixel_T * line = image.memptr() + row * step * width;
+				uint8_t * planeLine = _plane.data() + row * _planeWidth;
+				for (int column = 0; column < _planeWidth; ++column)
+				{
+					const Pixel_T & color = line[column * step];
+					planeLine[column] = std::max(color.red, std::max(color.green, color.blue));
+				}
+			}
+
+			// first non black plane line per side (-1 if the outer third is black)
+			int top, bottom, left, right;
+			if (!findPlaneBorder(top, bottom, left, right))
+			{
+				return detectedBorder;
+			}
+
+			// content rows of the image, the refinement searches between the last black and first non black sample
+			int firstRow = -1;
+			int lastRow = -1;
+			if (top >= 0)
+			{
+				firstRow = top * step;
+				for (int y = std::max(0, (top - 1) * step + 1); y < top * step; ++y)
+				{
+					if (!isBlackRow(image, y, step))
+					{
+						firstRow = y;
+						break;
+					}
+				}
+			}
+			if (bottom >= 0)
+			{
+				const int sample = _planeHeight - 1 - bottom;
+				lastRow = sample * step;
+				for (int y = std::min(height - 1, (sample + 1) * step - 1); y > sample * step; --y)
+				{
+					if (!isBlackRow(image, y, step))
+					{
+						lastRow = y;
+						break;
+					}
+				}
+			}
+
+			const int topSize = firstRow;
+			const int bottomSize = lastRow >= 0 ? height - 1 - lastRow : -1;
+			detectedBorder.horizontalSize = (topSize < 0 || (bottomSize >= 0 && bottomSize < topSize)) ? bottomSize : topSize;
+
+			// columns are only compared within the content rows
+			const int rowBegin = firstRow >= 0 ? firstRow : 0;
+			const int rowEnd = lastRow >= 0 ? lastRow + 1 : height;
+			int firstColumn = -1;
+			int lastColumn = -1;
+			if (left >= 0)
+			{
+				firstColumn = left * step;
+				for (int x = std::max(0, (left - 1) * step + 1); x < left * step; ++x)
+				{
+					if (!isBlackColumn(image, x, rowBegin, rowEnd, step))
+					{
+						firstColumn = x;
+						break;
+					}
+				}
+			}
+			if (right >= 0)
+			{
+				const int sample = _planeWidth - 1 - right;
+				lastColumn = sample * step;
+				for (int x = std::min(width - 1, (sample + 1) * step - 1); x > sample * step; --x)
+				{
+					if (!isBlackColumn(image, x, rowBegin, rowEnd, step))
+					{
+						lastColumn = x;
+						break;
+					}
+				}
+			}
+
+			const int leftSize = firstColumn;
+			const int rightSize = lastColumn >= 0 ? width - 1 - lastColumn : -1;
+			detectedBorder.verticalSize = (leftSize < 0 || (rightSize >= 0 && rightSize < leftSize)) ? rightSize : leftSize;
+
+			detectedBorder.unknown = false;
+			return detectedBorder;
+		}
+
 	private:
 
+		///
+		/// Checks if every step-th pixel of an image row is black
+		///
+		template <typename Pixel_T>
+		bool isBlackRow(const Image<Pixel_T> & image, int y, int step) const
+		{
+			const Pixel_T * line = image.memptr() + y * image.width();
+			for (unsigned x = 0; x < image.width(); x += step)
+			{
+				if (!isBlack(line[x]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		///
+		/// Checks if every step-th pixel of an image column between rowBegin and rowEnd is black
+		///
+		template <typename Pixel_T>
+		bool isBlackColumn(const Image<Pixel_T> & image, int x, int rowBegin, int rowEnd, int step) const
+		{
+			for (int y = rowBegin; y < rowEnd; y += step)
+			{
+				if (!isBlack(image(x, y)))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/// Sides of the plane, lines are counted from the side inwards
+		enum class Side { TOP, BOTTOM, LEFT, RIGHT };
+
+		///
+		/// Resizes the plane
+		///
+		void resizePlane(int width, int height);
+
+		///
+		/// Searches the first non black line of every side of the plane
+		///
+		/// @return False if the plane has no non black line within the outer third of both horizontal or both vertical sides
+		///
+		bool findPlaneBorder(int & top, int & bottom, int & left, int & right);
+
+		///
+		/// Searches the first non black line of a side within limit lines
+		///
+		/// @return The line index or -1 if all lines within the limit are black
+		///
+		int findSideBorder(Side side, int limit) const;
+
+		///
+		/// @return The index of the first non black line of a side in [begin, end) or -1 if all are black
+		///
+		int firstNonBlackLine(Side side, int begin, int end) const;
+
+		///
+		/// Checks if a line of the plane counted from the given side is black
+		///
+		bool isBlackLine(Side side, int index) const;
+
 		///
 		/// Checks if a given color is considered black and therefore could be part of the border.
 		///
@@ -298,5 +481,16 @@ namespace hyperion
 		/// Threshold for the black-border detector [0 .. 255]
 		const uint8_t _blackborderThreshold;
 
+		/// Maximum samples per side of the fullscan plane
+		static constexpr int FULLSCAN_PLANE_SIZE = 160;
+
+		/// Brightest channel per sampled pixel of the last frame (fullscan)
+		std::vector<uint8_t> _plane;
+		int _planeWidth;
+		int _planeHeight;
+
+		/// Brightest sample per plane column within the content rows (fullscan)
+		std::vector<uint8_t> _columnMax;
+
 	};
 } // end namespace hyperion
@@ -82,6 +82,8 @@ namespace hyperion
 				imageBorder = _detector->process_osd(image);
 			} else if (_detectionMode == "letterbox") {
 				imageBorder = _detector->process_letterbox(image);
+			} else if (_detectionMode == "fullscan") {
+				imageBorder = _detector->process_fullscan(image);
 			}
 			// add blur to the border
 			if (imageBorder.horizontalSize > 0)
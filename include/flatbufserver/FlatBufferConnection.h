@@ -5,9 +5,13 @@
 #include <QColor>
 #include <QImage>
 #include <QTcpSocket>
+#include <QLocalSocket>
 #include <QTimer>
 #include <QMap>
 
+// stl
+#include <memory>
+
 // hyperion util
 #include <utils/Image.h>
 #include <utils/ColorRgb.h>
@@ -21,6 +25,8 @@ namespace hyperionnet
 struct Reply;
 }
 
+class SharedImageBuffer;
+
 ///
 /// Connection class to setup an connection to the hyperion server and execute commands.
 ///
@@ -30,6 +36,15 @@ class FlatBufferConnection : public QObject
 	Q_OBJECT
 
 public:
+	/// Encodings of the images sent by setImage()
+	enum class ImageEncoding
+	{
+		RAW,  ///< uncompressed RGB
+		NV12, ///< 4:2:0 subsampled YUV, half the size of RAW
+		LZ4,  ///< lossless LZ4 compressed RGB
+		JPEG  ///< lossy JPEG
+	};
+
 	///
 	/// @brief Constructor
 	/// @param address The address of the Hyperion server (for example "192.168.0.32:19444)
@@ -45,6 +60,22 @@ public:
 	/// @brief Do not read reply messages from Hyperion if set to true
 	void setSkipReply(bool skip);
 
+	///
+	/// @brief Select the encoding of the images sent by setImage().
+	/// Raw RGB is sent as long as the server did not advertise the encoding in its register reply (never if replies are skipped)
+	/// or this build lacks the codec.
+	/// @param encoding     The image encoding
+	/// @param jpegQuality  The quality of JPEG images (1-100)
+	///
+	void setImageEncoding(ImageEncoding encoding, int jpegQuality = 75);
+
+	///
+	/// @brief Parse the name of an image encoding (raw, nv12, lz4, jpeg)
+	/// @param encoding  The name
+	/// @return The encoding, RAW if the name is unknown
+	///
+	static ImageEncoding parseImageEncoding(const QString& encoding);
+
 	///
 	/// @brief Register a new priority with given origin
 	/// @param origin  The user friendly origin string
@@ -111,10 +142,38 @@ private:
 	///
 	bool parseReply(const hyperionnet::Reply *reply);
 
+	///
+	/// @brief Get the encoding used for the image, the selected one if possible
+	/// @param image The image
+	/// @return The encoding
+	///
+	ImageEncoding imageEncodingFor(const Image<ColorRgb> &image) const;
+
+	///
+	/// @brief Publish the image in shared memory if connected through the local socket and accepted by the server
+	/// @param image The image
+	/// @return True if the image was published
+	///
+	bool writeSharedImage(const Image<ColorRgb> &image);
+
+	///
+	/// @return The state of the active socket
+	///
+	QAbstractSocket::SocketState socketState() const;
+
+	///
+	/// @brief Write a message with size header to the active socket
+	///
+	void writeMessage(const uint8_t* buffer, uint32_t size);
+
 private:
 	/// The TCP-Socket with the connection to the server
 	QTcpSocket _socket;
 
+	/// The local socket with the connection to a server on the same host, preferred over _socket
+	QLocalSocket _localSocket;
+	bool _localHost;
+
 	QString _origin;
 	int _priority;
 
@@ -134,4 +193,17 @@ private:
 	flatbuffers::FlatBufferBuilder _builder;
 
 	bool _registered;
+
+	ImageEncoding _imageEncoding;
+	int _jpegQuality;
+	/// bit mask of the ImageType values accepted by the server
+	uint32_t _serverImageTypes;
+	/// compressed image data
+	std::vector<uint8_t> _encodeBuffer;
+	/// turbojpeg handle, created with the first JPEG image
+	void* _jpegCompressor;
+
+	/// images for the server on the same host
+	std::unique_ptr<SharedImageBuffer> _sharedImage;
+	int _sharedImageGeneration;
 };
@@ -9,6 +9,7 @@
 
 class BonjourServiceRegister;
 class QTcpServer;
+class QLocalServer;
 class FlatBufferClient;
 class NetOrigin;
 
@@ -24,6 +25,14 @@ public:
 	FlatBufferServer(const QJsonDocument& config, QObject* parent = nullptr);
 	~FlatBufferServer() override;
 
+	///
+	/// @brief Name of the local socket of the server listening on the given port.
+	/// Clients on the same host connect to it instead of the TCP port and may send images by shared memory
+	/// @param port The TCP port of the server
+	/// @return The name of the local socket
+	///
+	static QString localServerName(quint16 port);
+
 public slots:
 	///
 	/// @brief Handle settings update
@@ -40,6 +49,11 @@ private slots:
 	///
 	void newConnection();
 
+	///
+	/// @brief Is called whenever a new local socket wants to connect
+	///
+	void newLocalConnection();
+
 	///
 	/// @brief is called whenever a client disconnected
 	///
@@ -56,9 +70,14 @@ private:
 	///
 	void stopServer();
 
+	///
+	/// @brief Connect a new client with Hyperion
+	///
+	void addClient(FlatBufferClient* client);
 
 private:
 	QTcpServer* _server;
+	QLocalServer* _localServer;
 	NetOrigin* _netOrigin;
 	Logger* _log;
 	int _timeout;
@@ -2,10 +2,15 @@
 
 // Qt includes
 #include <QThread>
+#include <QMap>
+#include <QSet>
+#include <QMutex>
+#include <QWaitCondition>
 
 // util includes
 #include <utils/PixelFormat.h>
 #include <utils/ImageResampler.h>
+#include <utils/LatencyTracer.h>
 
 // Determine the cmake options
 #include <HyperionConfig.h>
@@ -23,24 +28,54 @@ public:
 	explicit EncoderThread();
 	~EncoderThread();
 
+	///
+	/// @brief Prepare the next frame. Called from the capture thread while the encoder is idle,
+	/// marks the encoder as busy until process() has finished.
+	/// Data of a capture buffer (bufferIndex >= 0) is decoded in place, as the grabber keeps it untouched
+	/// until frameProcessed(). Other data is copied into a local buffer that is reused across frames.
+	///
+	/// @param frameIndex  Sequence number of the frame, used to restore the capture order
+	/// @param bufferIndex Capture buffer the data belongs to (-1 if the grabber does not need it back)
+	///
 	void setup(
+		quint64 frameIndex, int bufferIndex,
 		PixelFormat pixelFormat, uint8_t* sharedData,
 		int size, int width, int height, int lineLength,
 		unsigned cropLeft, unsigned cropTop, unsigned cropBottom, unsigned cropRight,
 		VideoMode videoMode, FlipMode flipMode, int pixelDecimation);
 
-	void process();
-
 	bool isBusy() { return _busy; }
 	QAtomicInt _busy = false;
 
+	///
+	/// @brief Block until the frame given with setup() has been processed
+	///
+	void waitUntilIdle();
+
+public slots:
+	///
+	/// @brief Decode the frame given with setup(). Runs on the encoder thread, always finishes with frameProcessed()
+	///
+	void process();
+
 signals:
-	void newFrame(const Image<ColorRgb>& data);
+	void newFrame(const Image<ColorRgb>& data, quint64 frameIndex);
+
+	///
+	/// @brief Emitted after every processed frame, also when decoding failed
+	///
+	void frameProcessed(quint64 frameIndex, int bufferIndex);
 
 private:
+	quint64				_frameIndex;
+	int					_bufferIndex;
+	qint64				_captureTime;
 	PixelFormat			_pixelFormat;
-	uint8_t*			_localData,
+	uint8_t*			_frameData,
+						*_localData,
 						*_flipBuffer;
+	unsigned long		_localDataSize,
+						_flipBufferSize;
 	int					_scalingFactorsCount,
 						_width,
 						_height,
@@ -54,6 +89,8 @@ private:
 						_cropRight;
 	FlipMode			_flipMode;
 	ImageResampler		_imageResampler;
+	QMutex				_idleMutex;
+	QWaitCondition		_idle;
 
 #ifdef HAVE_TURBO_JPEG
 	tjhandle			_transform, _decompress;
@@ -85,6 +122,7 @@ public:
 	EncoderThread* thread() const { return qobject_cast<EncoderThread*>(_thread); }
 
 	void setup(
+		quint64 frameIndex, int bufferIndex,
 		PixelFormat pixelFormat, uint8_t* sharedData,
 		int size, int width, int height, int lineLength,
 		unsigned cropLeft, unsigned cropTop, unsigned cropBottom, unsigned cropRight,
@@ -92,7 +130,7 @@ public:
 	{
 		auto encThread = qobject_cast<EncoderThread*>(_thread);
 		if (encThread != nullptr)
-			encThread->setup(pixelFormat, sharedData,
+			encThread->setup(frameIndex, bufferIndex, pixelFormat, sharedData,
 				size, width, height, lineLength,
 				cropLeft, cropTop, cropBottom, cropRight,
 				videoMode, flipMode, pixelDecimation);
@@ -107,11 +145,17 @@ public:
 		return true;
 	}
 
-	void process()
+	void waitUntilIdle()
 	{
 		auto encThread = qobject_cast<EncoderThread*>(_thread);
 		if (encThread != nullptr)
-			encThread->process();
+			encThread->waitUntilIdle();
+	}
+
+	void process()
+	{
+		// decode on the encoder thread, the caller continues immediately
+		QMetaObject::invokeMethod(_thread, "process", Qt::QueuedConnection);
 	}
 
 protected:
@@ -122,6 +166,11 @@ protected:
 	}
 };
 
+///
+/// Dispatches captured frames to a pool of encoder threads. Frames are decoded in parallel,
+/// but newFrame() is emitted in capture order. Capture buffers are handed back with
+/// releaseBuffer() as soon as their frame has been decoded.
+///
 class EncoderThreadManager : public QObject
 {
     Q_OBJECT
@@ -130,12 +179,17 @@ public:
 		: QObject(parent)
 		, _threadCount(qMax(QThread::idealThreadCount(), 1))
 		, _threads(nullptr)
+		, _sessionStartIndex(0)
+		, _nextFrameIndex(0)
+		, _nextEmitIndex(0)
+		, _processedFrames(0)
+		, _droppedFrames(0)
 	{
 		_threads = new Thread<EncoderThread>*[_threadCount];
 		for (int i = 0; i < _threadCount; i++)
 		{
 			_threads[i] = new Thread<EncoderThread>(new EncoderThread, this);
-			_threads[i]->setObjectName("Encoder " + i);
+			_threads[i]->setObjectName("Encoder " + QString::number(i));
 		}
 	}
 
@@ -156,21 +210,129 @@ public:
 
 	void start()
 	{
+		// the frame numbering continues across sessions, late results of the previous one stay below the start index
+		_sessionStartIndex = _nextEmitIndex = _nextFrameIndex;
+		_processedFrames = _droppedFrames = 0;
+		_pendingFrames.clear();
+		_failedFrames.clear();
+
 		if (_threads != nullptr)
 			for (int i = 0; i < _threadCount; i++)
-				connect(_threads[i]->thread(), &EncoderThread::newFrame, this, &EncoderThreadManager::newFrame);
+			{
+				connect(_threads[i]->thread(), &EncoderThread::newFrame, this, &EncoderThreadManager::handleNewFrame);
+				connect(_threads[i]->thread(), &EncoderThread::frameProcessed, this, &EncoderThreadManager::handleFrameProcessed);
+			}
 	}
 
 	void stop()
 	{
 		if (_threads != nullptr)
 			for(int i = 0; i < _threadCount; i++)
+			{
 				disconnect(_threads[i]->thread(), nullptr, nullptr, nullptr);
+
+				// encoders may still read from capture buffers that are about to be released
+				_threads[i]->waitUntilIdle();
+			}
+	}
+
+	///
+	/// @brief Hand a captured frame to the next idle encoder thread. Has to be called from the capture thread.
+	///
+	/// @param bufferIndex Capture buffer holding the data, given back via releaseBuffer() once decoded (-1 for none)
+	/// @return True, if an encoder took the frame. Otherwise the frame is dropped and the buffer can be reused at once.
+	///
+	bool process(
+		int bufferIndex, PixelFormat pixelFormat, uint8_t* sharedData,
+		int size, int width, int height, int lineLength,
+		unsigned cropLeft, unsigned cropTop, unsigned cropBottom, unsigned cropRight,
+		VideoMode videoMode, FlipMode flipMode, int pixelDecimation)
+	{
+		if (_threads != nullptr)
+			for (int i = 0; i < _threadCount; i++)
+			{
+				if (!_threads[i]->isBusy())
+				{
+					_threads[i]->setup(_nextFrameIndex++, bufferIndex, pixelFormat, sharedData, size, width, height, lineLength, cropLeft, cropTop, cropBottom, cropRight, videoMode, flipMode, pixelDecimation);
+					_threads[i]->process();
+					return true;
+				}
+			}
+
+		// all encoders busy
+		_droppedFrames++;
+		return false;
 	}
 
+	/// Number of frames emitted since start()
+	quint64 processedFrames() const { return _processedFrames; }
+
+	/// Number of frames dropped since start(), either as all encoders were busy or decoding failed
+	quint64 droppedFrames() const { return _droppedFrames; }
+
 	int					_threadCount;
 	Thread<EncoderThread>**	_threads;
 
 signals:
 	void newFrame(const Image<ColorRgb>& data);
+
+	///
+	/// @brief The encoder is done with the given capture buffer, it may be queued again
+	///
+	void releaseBuffer(int bufferIndex);
+
+private slots:
+	void handleNewFrame(const Image<ColorRgb>& data, quint64 frameIndex)
+	{
+		if (frameIndex < _sessionStartIndex)
+			return;
+
+		_pendingFrames.insert(frameIndex, data);
+	}
+
+	void handleFrameProcessed(quint64 frameIndex, int bufferIndex)
+	{
+		// the capture buffers of a previous session are gone already
+		if (frameIndex < _sessionStartIndex)
+			return;
+
+		if (bufferIndex >= 0)
+			emit releaseBuffer(bufferIndex);
+
+		// frames without image failed to decode, keep a marker to not stall the ordering
+		if (!_pendingFrames.contains(frameIndex))
+		{
+			_failedFrames.insert(frameIndex);
+		}
+
+		// emit all frames that are complete in capture order
+		while (true)
+		{
+			auto it = _pendingFrames.find(_nextEmitIndex);
+			if (it != _pendingFrames.end())
+			{
+				_processedFrames++;
+				Image<ColorRgb> image = it.value();
+				_pendingFrames.erase(it);
+				_nextEmitIndex++;
+				emit newFrame(image);
+			}
+			else if (_failedFrames.remove(_nextEmitIndex) > 0)
+			{
+				_droppedFrames++;
+				_nextEmitIndex++;
+			}
+			else
+				break;
+		}
+	}
+
+private:
+	quint64							_sessionStartIndex;
+	quint64							_nextFrameIndex;
+	quint64							_nextEmitIndex;
+	quint64							_processedFrames;
+	quint64							_droppedFrames;
+	QMap<quint64, Image<ColorRgb>>	_pendingFrames;
+	QSet<quint64>					_failedFrames;
 };
@@ -107,6 +107,12 @@ signals:
 private slots:
 	int read_frame();
 
+	///
+	/// @brief Queue a capture buffer again, once the encoder thread has finished with it
+	/// @param bufferIndex Index of the buffer in _buffers
+	///
+	void releaseBuffer(int bufferIndex);
+
 private:
 	bool init();
 	void uninit();
@@ -119,7 +125,7 @@ private:
 	void uninit_device();
 	void start_capturing();
 	void stop_capturing();
-	bool process_image(const void *p, int size);
+	bool process_image(int bufferIndex, const void *p, int size);
 	int xioctl(int request, void *arg);
 	int xioctl(int fileDescriptor, int request, void *arg);
 
@@ -15,6 +15,7 @@
 #include <utils/PixelFormat.h>
 #include <utils/settings.h>
 #include <utils/VideoStandard.h>
+#include <utils/LatencyTracer.h>
 
 class Grabber;
 class GlobalSignals;
@@ -87,10 +88,15 @@ public:
 			_image.resize(w, h);
 		}
 
+		_image.setCaptureTime(LatencyTracer::now());
 		int ret = grabber.grabFrame(_image);
 		if (ret >= 0)
 		{
-			emit systemImage(_grabberName, _image);
+			// a static screen is only forwarded to keep the input alive, Hyperion does not process identical frames
+			if (!isUnchangedFrame(_image))
+			{
+				emit systemImage(_grabberName, _image);
+			}
 			return true;
 		}
 		return false;
@@ -163,6 +169,13 @@ protected:
 	///
 	virtual bool close() { return true; }
 
+	///
+	/// @brief Compares the grabbed image with the previously forwarded one by a hash of all pixels
+	/// @param image The grabbed (decimated) image
+	/// @return True if the image is unchanged and was forwarded recently, so it does not need to be forwarded
+	///
+	bool isUnchangedFrame(const Image<ColorRgb>& image);
+
 
 	QString _grabberName;
 
@@ -179,4 +192,10 @@ protected:
 
 	/// The image used for grabbing frames
 	Image<ColorRgb> _image;
+
+	/// Hash of the previously forwarded image
+	uint64_t _forwardedImageHash;
+
+	/// Capture time of the previously forwarded image
+	qint64 _forwardedImageTime;
 };
@@ -371,6 +371,18 @@ public slots:
 
 	int getLatchTime() const;
 
+	///
+	/// @brief Get the statistics of the LedDevice frame mailbox (written/dropped frames and queue age in ms)
+	/// @return Statistics as JSON object
+	///
+	QJsonObject getLedDeviceStatistics() const;
+
+	///
+	/// @brief Get the state of the forwarder connections to the json slaves
+	/// @return Statistics of each json slave
+	///
+	QJsonArray getForwarderStatistics() const;
+
 signals:
 	/// Signal which is emitted when a priority channel is actively cleared
 	/// This signal will not be emitted when a priority channel time out
@@ -480,6 +492,11 @@ private slots:
 	void handlePriorityChangedLedDevice(const quint8& priority);
 
 private:
+	///
+	/// @brief Pass the color order of the leds and the hardware led count to the led output stage of _raw2ledAdjustment
+	///
+	void updateLedOutputLayout();
+
 	friend class HyperionDaemon;
 	friend class HyperionIManager;
 
@@ -537,9 +554,12 @@ private:
 	/// Capture control for Daemon native capture
 	CaptureCont* _captureCont;
 
-	/// buffer for leds (with adjustment)
+	/// buffer for leds (before adjustment)
 	std::vector<ColorRgb> _ledBuffer;
 
+	/// buffer for the device (adjusted, in device color order and padded to the hardware led count)
+	std::vector<ColorRgb> _ledOutputBuffer;
+
 	VideoMode _currVideoMode = VideoMode::VIDEO_2D;
 
 	/// Boblight instance
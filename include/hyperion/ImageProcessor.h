@@ -1,5 +1,9 @@
 #pragma once
 
+// STL includes
+#include <list>
+#include <memory>
+
 #include <QString>
 
 // Utils includes
@@ -134,7 +138,8 @@ public:
 	}
 
 	///
-	/// Determines the led colors of the image in the buffer.
+	/// Determines the led colors of the image in the buffer. The buffer is resized to the number of leds,
+	/// so a buffer reused across frames is not reallocated.
 	///
 	/// @param[in] image  The image to translate to led values
 	/// @param[out] ledColors  The color value per led
@@ -150,6 +155,8 @@ public:
 			// Check black border detection
 			verifyBorder(image);
 
+			ledColors.resize(_ledString.leds().size());
+
 			// Determine the mean or uni colors of each led (using the existing mapping)
 			switch (_mappingType)
 			{
@@ -187,26 +194,22 @@ private:
 		{
 			Debug(_log, "Reset border");
 			_borderProcessor->process(image);
-			delete _imageToLeds;
-			_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds());
+			useImageToLedsMap(image.width(), image.height(), 0, 0);
 		}
 
 		if(_borderProcessor->enabled() && _borderProcessor->process(image))
 		{
 			const hyperion::BlackBorder border = _borderProcessor->getCurrentBorder();
 
-			// Clean up the old mapping
-			delete _imageToLeds;
-
 			if (border.unknown)
 			{
-				// Construct a new buffer and mapping
-				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds());
+				// Switch to the mapping without border
+				useImageToLedsMap(image.width(), image.height(), 0, 0);
 			}
 			else
 			{
-				// Construct a new buffer and mapping
-				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), border.horizontalSize, border.verticalSize, _ledString.leds());
+				// Switch to the mapping of the border
+				useImageToLedsMap(image.width(), image.height(), border.horizontalSize, border.verticalSize);
 			}
 
 			//Debug(Logger::getInstance("BLACKBORDER"),  "CURRENT BORDER TYPE: unknown=%d hor.size=%d vert.size=%d",
@@ -214,6 +217,17 @@ private:
 		}
 	}
 
+	///
+	/// Makes the mapping of the given image size and border the current one. Recently used mappings are
+	/// cached, so a border that flips back and forth (e.g. letterbox trailers) does not rebuild them.
+	///
+	/// @param[in] width             The width of the image
+	/// @param[in] height            The height of the image
+	/// @param[in] horizontalBorder  The size of the horizontal border
+	/// @param[in] verticalBorder    The size of the vertical border
+	///
+	void useImageToLedsMap(unsigned width, unsigned height, unsigned horizontalBorder, unsigned verticalBorder);
+
 private slots:
 	void handleSettingsUpdate(settings::type type, const QJsonDocument& config);
 
@@ -228,6 +242,12 @@ private:
 	/// The mapping of image-pixels to LEDs
 	hyperion::ImageToLedsMap* _imageToLeds;
 
+	/// The recently used mappings of the current led string, most recently used first
+	std::list<std::unique_ptr<hyperion::ImageToLedsMap>> _imageToLedsCache;
+
+	/// The summed-area table buffer of all mappings, only one mapping is used per image
+	std::shared_ptr<std::vector<uint32_t>> _integralImage;
+
 	/// Type of image 2 led mapping
 	int _mappingType;
 	/// Type of last requested user type
@@ -3,6 +3,7 @@
 
 // STL includes
 #include <cassert>
+#include <memory>
 #include <sstream>
 
 // hyperion-utils includes
@@ -16,16 +17,18 @@ namespace hyperion
 {
 
 	///
-	/// The ImageToLedsMap holds a mapping of indices into an image to leds. It can be used to
+	/// The ImageToLedsMap holds a mapping of rectangular image regions to leds. It can be used to
 	/// calculate the average (or mean) color per led for a specific region.
+	/// When the led regions cover more pixels than the image itself (e.g. overlapping regions), the
+	/// means are derived from a summed-area table that is built with a single pass over the image.
 	///
 	class ImageToLedsMap
 	{
 	public:
 
 		///
-		/// Constructs an mapping from the absolute indices in an image to each led based on the border
-		/// definition given in the list of leds. The map holds absolute indices to any given image,
+		/// Constructs an mapping from the image regions to each led based on the border
+		/// definition given in the list of leds. The map holds absolute pixel coordinates to any given image,
 		/// provided that it is row-oriented.
 		/// The mapping is created purely on size (width and height). The given borders are excluded
 		/// from indexing.
@@ -35,13 +38,16 @@ namespace hyperion
 		/// @param[in] horizontalBorder The size of the horizontal border (0=no border)
 		/// @param[in] verticalBorder   The size of the vertical border (0=no border)
 		/// @param[in] leds             The list with led specifications
+		/// @param[in] integralImage    Buffer for the summed-area table, shared by maps that are used one at a time
+		///                             (a map without one allocates its own)
 		///
 		ImageToLedsMap(
 				const unsigned width,
 				const unsigned height,
 				const unsigned horizontalBorder,
 				const unsigned verticalBorder,
-				const std::vector<Led> & leds);
+				const std::vector<Led> & leds,
+				std::shared_ptr<std::vector<uint32_t>> integralImage = nullptr);
 
 		///
 		/// Returns the width of the indexed image
@@ -94,12 +100,23 @@ namespace hyperion
 				return;
 			}
 
-			// Iterate each led and compute the mean
 			auto led = ledColors.begin();
-			for (auto colors = _colorsMap.begin(); colors != _colorsMap.end(); ++colors, ++led)
+			if (_useIntegralImage)
 			{
-				const ColorRgb color = calcMeanColor(image, *colors);
-				*led = color;
+				// One pass over the frame, then four lookups per led
+				buildIntegralImage(image);
+				for (auto region = _colorsMap.begin(); region != _colorsMap.end(); ++region, ++led)
+				{
+					*led = calcMeanColorIntegral(*region);
+				}
+			}
+			else
+			{
+				// Iterate each led and compute the mean
+				for (auto region = _colorsMap.begin(); region != _colorsMap.end(); ++region, ++led)
+				{
+					*led = calcMeanColor(image, *region);
+				}
 			}
 		}
 
@@ -153,24 +170,45 @@ namespace hyperion
 
 		const unsigned _verticalBorder;
 
-		/// The absolute indices into the image for each led
-		std::vector<std::vector<int32_t>> _colorsMap;
+		///
+		/// Rectangular image region of a single led, stored as half-open ranges
+		/// [minX, maxX) x [minY, maxY) of absolute pixel coordinates
+		///
+		struct LedRegion
+		{
+			unsigned minX;
+			unsigned maxX;
+			unsigned minY;
+			unsigned maxY;
+
+			unsigned area() const { return (maxX - minX) * (maxY - minY); }
+		};
+
+		/// The image region for each led (an empty region for leds without area)
+		std::vector<LedRegion> _colorsMap;
+
+		/// When true the leds are evaluated via the summed-area table, otherwise each region is scanned directly
+		bool _useIntegralImage;
+
+		/// Summed-area table of the last processed image, (width+1)*(height+1) entries with three channels each.
+		/// It is rebuilt for every image, so the buffer may be shared with other maps of the same user.
+		std::shared_ptr<std::vector<uint32_t>> _integralImage;
 
 		///
-		/// Calculates the 'mean color' of the given list. This is the mean over each color-channel
+		/// Calculates the 'mean color' of the given region. This is the mean over each color-channel
 		/// (red, green, blue)
 		///
 		/// @param[in] image The image a section from which an average color must be computed
-		/// @param[in] colors  The list with colors
+		/// @param[in] region  The region of the led
 		///
-		/// @return The mean of the given list of colors (or black when empty)
+		/// @return The mean of the given region (or black when empty)
 		///
 		template <typename Pixel_T>
-		ColorRgb calcMeanColor(const Image<Pixel_T> & image, const std::vector<int32_t> & colors) const
+		ColorRgb calcMeanColor(const Image<Pixel_T> & image, const LedRegion & region) const
 		{
-			const auto colorVecSize = colors.size();
+			const unsigned regionSize = region.area();
 
-			if (colorVecSize == 0)
+			if (regionSize == 0)
 			{
 				return ColorRgb::BLACK;
 			}
@@ -181,23 +219,99 @@ namespace hyperion
 			uint_fast32_t cummBlue  = 0;
 			const auto& imgData = image.memptr();
 
-			for (const unsigned colorOffset : colors)
+			for (unsigned y = region.minY; y < region.maxY; ++y)
 			{
-				const auto& pixel = imgData[colorOffset];
-				cummRed   += pixel.red;
-				cummGreen += pixel.green;
-				cummBlue  += pixel.blue;
+				const Pixel_T* pixel = imgData + y*_width + region.minX;
+				const Pixel_T* rowEnd = imgData + y*_width + region.maxX;
+				for (; pixel != rowEnd; ++pixel)
+				{
+					cummRed   += pixel->red;
+					cummGreen += pixel->green;
+					cummBlue  += pixel->blue;
+				}
 			}
 
 			// Compute the average of each color channel
-			const uint8_t avgRed   = uint8_t(cummRed/colorVecSize);
-			const uint8_t avgGreen = uint8_t(cummGreen/colorVecSize);
-			const uint8_t avgBlue  = uint8_t(cummBlue/colorVecSize);
+			const uint8_t avgRed   = uint8_t(cummRed/regionSize);
+			const uint8_t avgGreen = uint8_t(cummGreen/regionSize);
+			const uint8_t avgBlue  = uint8_t(cummBlue/regionSize);
 
 			// Return the computed color
 			return {avgRed, avgGreen, avgBlue};
 		}
 
+		///
+		/// Fills the summed-area table with the given image. Entry (x,y) holds the per channel sum of all
+		/// pixels left of x and above y. The sums are kept in 32 bit and may wrap for huge images, region
+		/// sums derived from them remain exact as long as a single region stays below 2^24 pixels.
+		///
+		/// @param[in] image The image to integrate
+		///
+		template <typename Pixel_T>
+		void buildIntegralImage(const Image<Pixel_T> & image) const
+		{
+			const unsigned stride = (_width + 1) * 3;
+			std::vector<uint32_t>& integralImage = *_integralImage;
+			integralImage.resize(size_t(stride) * (_height + 1));
+
+			// first row and first column stay zero
+			std::fill(integralImage.begin(), integralImage.begin() + stride, 0);
+
+			const Pixel_T* pixel = image.memptr();
+			for (unsigned y = 0; y < _height; ++y)
+			{
+				const uint32_t* above = integralImage.data() + size_t(y) * stride;
+				uint32_t* row = integralImage.data() + size_t(y + 1) * stride;
+				row[0] = row[1] = row[2] = 0;
+
+				uint32_t rowRed   = 0;
+				uint32_t rowGreen = 0;
+				uint32_t rowBlue  = 0;
+				for (unsigned x = 0; x < _width; ++x, ++pixel)
+				{
+					rowRed   += pixel->red;
+					rowGreen += pixel->green;
+					rowBlue  += pixel->blue;
+
+					const unsigned idx = (x + 1) * 3;
+					row[idx]     = above[idx]     + rowRed;
+					row[idx + 1] = above[idx + 1] + rowGreen;
+					row[idx + 2] = above[idx + 2] + rowBlue;
+				}
+			}
+		}
+
+		///
+		/// Calculates the 'mean color' of the given region from the summed-area table
+		///
+		/// @param[in] region  The region of the led
+		///
+		/// @return The mean of the given region (or black when empty)
+		///
+		ColorRgb calcMeanColorIntegral(const LedRegion & region) const
+		{
+			const unsigned regionSize = region.area();
+
+			if (regionSize == 0)
+			{
+				return ColorRgb::BLACK;
+			}
+
+			const unsigned stride = (_width + 1) * 3;
+			const uint32_t* table = _integralImage->data();
+			const uint32_t* topLeft     = table + size_t(region.minY) * stride + region.minX * 3;
+			const uint32_t* topRight    = table + size_t(region.minY) * stride + region.maxX * 3;
+			const uint32_t* bottomLeft  = table + size_t(region.maxY) * stride + region.minX * 3;
+			const uint32_t* bottomRight = table + size_t(region.maxY) * stride + region.maxX * 3;
+
+			// Compute the average of each color channel
+			const uint8_t avgRed   = uint8_t(uint32_t(bottomRight[0] - bottomLeft[0] - topRight[0] + topLeft[0]) / regionSize);
+			const uint8_t avgGreen = uint8_t(uint32_t(bottomRight[1] - bottomLeft[1] - topRight[1] + topLeft[1]) / regionSize);
+			const uint8_t avgBlue  = uint8_t(uint32_t(bottomRight[2] - bottomLeft[2] - topRight[2] + topLeft[2]) / regionSize);
+
+			return {avgRed, avgGreen, avgBlue};
+		}
+
 		///
 		/// Calculates the 'mean color' over the given image. This is the mean over each color-channel
 		/// (red, green, blue)
@@ -13,6 +13,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QMutex>
 
 // Utils includes
 #include <utils/ColorRgb.h>
@@ -26,8 +27,8 @@
 
 // Forward declaration
 class Hyperion;
-class QTcpSocket;
 class FlatBufferConnection;
+class JsonForwardConnection;
 
 class MessageForwarder : public QObject
 {
@@ -39,6 +40,12 @@ public:
 	void addJsonSlave(const QString& slave);
 	void addFlatbufferSlave(const QString& slave);
 
+	///
+	/// @brief Get the state of the json slave connections, can be called from any thread
+	/// @return Statistics of each json slave
+	///
+	QJsonArray getJsonSlaveStatistics() const;
+
 private slots:
 	///
 	/// @brief Handle settings update from Hyperion Settingsmanager emit or this constructor
@@ -72,12 +79,11 @@ private slots:
 	///
 	void forwardFlatbufferMessage(const QString& name, const Image<ColorRgb> &image);
 
+private:
 	///
-	/// @brief Forward message to a single json slave
-	/// @param message The JSON message to send
-	/// @param socket The TCP-Socket with the connection to the slave
+	/// @brief Delete all json and flatbuffer slave connections
 	///
-	void sendJsonMessage(const QJsonObject &message, QTcpSocket *socket);
+	void clearSlaves();
 
 private:
 	/// Hyperion instance
@@ -91,6 +97,9 @@ private:
 
 	// JSON connection for forwarding
 	QStringList   _jsonSlaves;
+	QList<JsonForwardConnection*> _jsonClients;
+	/// guards _jsonClients against getJsonSlaveStatistics()
+	mutable QMutex _jsonClientsMutex;
 
 	/// Proto connection for forwarding
 	QStringList _flatSlaves;
@@ -4,10 +4,12 @@
 #include <vector>
 #include <QStringList>
 #include <QString>
+#include <QMutex>
 
 // Hyperion includes
 #include <utils/ColorRgb.h>
 #include <hyperion/ColorAdjustment.h>
+#include <hyperion/LedString.h>
 
 ///
 /// The LedColorTransform is responsible for performing color transformation from 'raw' colors
@@ -48,13 +50,59 @@ public:
 	ColorAdjustment* getAdjustment(const QString& id);
 
 	///
-	/// Performs the color adjustment from raw-color to led-color
+	/// Sets the color order of the leds and the number of hardware leds used by applyAdjustment()
 	///
-	/// @param ledColors The list with raw colors
+	/// @param colorOrders The color order per led
+	/// @param hardwareLedCount The number of leds of the device, additional leds are black
 	///
-	void applyAdjustment(std::vector<ColorRgb>& ledColors);
+	void setOutputLayout(const std::vector<ColorOrder>& colorOrders, int hardwareLedCount);
+
+	///
+	/// Performs the color adjustment from raw-color to led-color, the color order per led and the padding to
+	/// the hardware led count in a single pass
+	///
+	/// @param rawColors The list with raw colors
+	/// @param ledColors The list with led colors, reused across calls (only resized when the layout changes)
+	///
+	void applyAdjustment(const std::vector<ColorRgb>& rawColors, std::vector<ColorRgb>& ledColors);
+
+	///
+	/// Marks the compiled adjustment tables as outdated, they are rebuilt with the next applyAdjustment().
+	/// Has to be called whenever a ColorAdjustment has been changed.
+	///
+	void updateAdjustments();
 
 private:
+	///
+	/// Flattened lookup tables of a single ColorAdjustment for the current brightness
+	///
+	struct CompiledAdjustment
+	{
+		/// The source adjustment (provides the gamma/backlight transform)
+		ColorAdjustment* adjustment;
+		/// The rgb contribution of each corner (black, red, green, blue, cyan, magenta, yellow, white) per corner weight
+		uint8_t mapping[8][256][3];
+	};
+
+	///
+	/// A range of consecutive leds sharing the same ColorAdjustment and color order
+	///
+	struct LedSpan
+	{
+		size_t startLed;
+		size_t endLed;
+		/// The compiled adjustment (nullptr for leds without adjustment)
+		const CompiledAdjustment* compiled;
+		/// The adjusted channel (0=red, 1=green, 2=blue) written to the red, green and blue byte of the led
+		uint8_t channels[3];
+	};
+
+	///
+	/// Rebuilds the compiled tables and led spans from the current adjustments, called with _mutex held
+	///
+	void compileAdjustments();
+
+
 	/// List with transform ids
 	QStringList _adjustmentIds;
 
@@ -64,6 +112,25 @@ private:
 	/// List with a pointer to the ColorAdjustment for each individual led
 	std::vector<ColorAdjustment*> _ledAdjustments;
 
+	/// Compiled tables, one per unique ColorAdjustment
+	std::vector<CompiledAdjustment> _compiledAdjustments;
+
+	/// Consecutive leds grouped by their compiled adjustment and color order
+	std::vector<LedSpan> _ledSpans;
+
+	/// The color order per led
+	std::vector<ColorOrder> _colorOrders;
+
+	/// The number of leds of the device
+	int _hardwareLedCount;
+
+	/// True if the compiled tables have to be rebuilt
+	bool _compiledOutdated;
+
+	/// Guards the adjustments, their led assignment, the output layout and the compiled tables,
+	/// which are updated by the settings and used by applyAdjustment()
+	QMutex _mutex;
+
 	// logger instance
 	Logger * _log;
 };
@@ -2,6 +2,9 @@
 
 // STL includes
 #include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
 #include <cstdint>
 
 // QT includes
@@ -77,7 +80,7 @@ public:
 	~PriorityMuxer() override;
 
 	///
-	/// @brief Start/Stop the PriorityMuxer update timer; On disabled no priority and timeout updates will be performend
+	/// @brief Start/Stop the PriorityMuxer timeout timer; On disabled no timeout updates will be performend
 	/// @param  enable  The new state
 	///
 	void setEnable(bool enable);
@@ -142,9 +145,9 @@ public:
 	///
 	/// @param priority The priority channel
 	///
-	/// @return The information for the specified priority channel
+	/// @return The information for the specified priority channel, valid until the channel is updated or cleared
 	///
-	InputInfo getInputInfo(int priority) const;
+	const InputInfo& getInputInfo(int priority) const;
 
 	///
 	/// @brief  Register a new input by priority, the priority is not active (timeout -100 isn't muxer recognized) until you start to update the data with setInput()
@@ -229,6 +232,11 @@ signals:
 	///
 	void signalTimeTrigger();
 
+	///
+	/// internal used signal to arm the timeout timer from the muxer thread
+	///
+	void signalTimeoutScheduled();
+
 private slots:
 	///
 	/// Slot which is called to adapt to 1s interval for signal timeRunner() / prioritiesChanged()
@@ -241,6 +249,16 @@ private slots:
 	///
 	void setCurrentTime();
 
+	///
+	/// Called when the earliest queued timeout is due, clears the expired priorities
+	///
+	void handleTimeouts();
+
+	///
+	/// Arms the timeout timer for the earliest queued timeout
+	///
+	void armTimeoutTimer();
+
 private:
 	///
 	/// @brief Get the component of the given priority
@@ -248,6 +266,20 @@ private:
 	///
 	hyperion::Components getComponentOfPriority(int priority) const;
 
+	///
+	/// @brief Queue the timeout of a priority, unless an earlier timeout of it is queued already
+	/// @param priority             The priority
+	/// @param previousTimeout_ms   The timeout of the priority before the update
+	/// @param timeout_ms           The new timeout
+	///
+	void scheduleTimeout(int priority, int64_t previousTimeout_ms, int64_t timeout_ms);
+
+	///
+	/// @brief Check for a color, effect or image with timeout, which updates the remaining time once per second
+	/// @return True if the input has a running timeout
+	///
+	static bool hasRunningTimeout(const InputInfo& input);
+
 	/// Logger instance
 	Logger* _log;
 
@@ -272,8 +304,15 @@ private:
 	// Reflect the state of auto select
 	bool _sourceAutoSelectEnabled;
 
-	// Timer to update Muxer times independent
-	QTimer* _updateTimer;
+	/// Timeouts (absolute time, priority) by due time. Entries are checked when due: cleared priorities are skipped,
+	/// extended timeouts are queued again, so there is at most one entry per priority at or before its timeout
+	std::priority_queue<std::pair<int64_t, int>, std::vector<std::pair<int64_t, int>>, std::greater<std::pair<int64_t, int>>> _timeoutQueue;
+
+	// Single shot timer for the earliest queued timeout
+	QTimer* _timeoutTimer;
+
+	// Reflect the state of timeout handling
+	bool _enabled;
 
 	QTimer* _timer;
 	QTimer* _blockTimer;
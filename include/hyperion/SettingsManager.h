@@ -8,6 +8,9 @@ using namespace semver;
 
 // qt includes
 #include <QJsonObject>
+#include <QJsonDocument>
+#include <QMap>
+#include <QMutex>
 
 const int GLOABL_INSTANCE_ID = 255;
 
@@ -37,14 +40,14 @@ public:
 	bool saveSettings(QJsonObject config, bool correct = false);
 
 	///
-	/// @brief get a single setting json from configuration
+	/// @brief get a single setting json from configuration, served from the in-memory snapshot
 	/// @param type   The settings::type from enum
 	/// @return The requested json data as QJsonDocument
 	///
 	QJsonDocument getSetting(settings::type type) const;
 
 	///
-	/// @brief get the full settings object of this instance (with global settings)
+	/// @brief get the full settings object of this instance (with global settings), served from the in-memory snapshot
 	/// @return The requested json
 	///
 	QJsonObject getSettings() const;
@@ -68,6 +71,19 @@ private:
 
 	bool resolveConfigVersion(QJsonObject& config);
 
+	///
+	/// @brief Get a setting from the snapshot, unknown settings are read from the database once
+	/// @param key The settings type as string
+	/// @return The setting data
+	///
+	QJsonDocument getSnapshotSetting(const QString& key) const;
+
+	///
+	/// @brief Replace settings in the snapshot. Global settings are stored in the snapshot shared by all instances
+	/// @param settings The settings per type as string
+	///
+	void updateSnapshot(const QMap<QString, QJsonDocument>& settings) const;
+
 	/// Logger instance
 	Logger* _log;
 
@@ -86,6 +102,10 @@ private:
 	/// the current configuration of this instance
 	QJsonObject _qconfig;
 
+	/// parsed settings of this instance as stored in the database, global settings are kept in a process wide snapshot
+	mutable QMap<QString, QJsonDocument> _snapshot;
+	mutable QMutex _snapshotMutex;
+
 	semver::version _configVersion;
 	semver::version _previousVersion;
 
@@ -7,6 +7,7 @@
 #include <utils/Components.h>
 
 #include <QMutex>
+#include <QJsonObject>
 
 class LedDevice;
 class Hyperion;
@@ -72,7 +73,27 @@ public:
 	///
 	unsigned int getLedCount() const;
 
+	///
+	/// @brief Get the statistics of the led value mailbox (written/dropped frames and queue age)
+	/// @return Statistics as JSON object
+	///
+	QJsonObject getMailboxStatistics() const;
+
+	///
+	/// @brief Set the capture time of the image the following led values are computed from, used for latency tracing
+	/// @param captureTime  The capture time (LatencyTracer::now()), 0 if the values do not originate from a captured image
+	///
+	void setCaptureTime(qint64 captureTime);
+
 public slots:
+	///
+	/// @brief Hand new led values over to the LedDevice. Only the newest frame is kept, a frame that has not
+	/// been written yet is replaced and counted as dropped. The device thread always writes the latest frame.
+	///
+	/// @param[in] ledValues  The RGB-color per led
+	///
+	void updateLeds(const std::vector<ColorRgb>& ledValues);
+
 	///
 	/// @brief Handle new component state request
 	/// @param component  The comp from enum
@@ -82,13 +103,9 @@ public slots:
 
 signals:
 	///
-	/// PIPER signal for Hyperion -> LedDevice
-	///
-	/// @param[in] ledValues  The RGB-color per led
-	///
-	/// @return Zero on success else negative
+	/// @brief Emits when the mailbox received a frame and no write is pending on the device thread
 	///
-	int updateLeds(const std::vector<ColorRgb>& ledValues);
+	void ledValuesPending();
 
 	///
 	/// @brief Enables the LED-Device.
@@ -132,13 +149,37 @@ private:
 	///
 	void stopDeviceThread();
 
+	///
+	/// @brief Takes the newest frame from the mailbox and writes it to the LedDevice. Runs in the device thread
+	///
+	void writePendingLeds();
+
 private:
 	// parent Hyperion
 	Hyperion* _hyperion;
-	// Pointer of current led device
+	// Pointer of current led device, written under _mailboxMutex as updateLeds() checks it from the smoothing output thread
 	LedDevice* _ledDevice;
 	// the enable state
 	bool _enabled;
+
+	/// guards the mailbox members below
+	mutable QMutex _mailboxMutex;
+	/// the newest led values not yet written to the device
+	std::vector<ColorRgb> _pendingLedValues;
+	/// the led values currently written by the device thread
+	std::vector<ColorRgb> _writeLedValues;
+	/// true while a write request is queued in the device thread
+	bool _writePending;
+	/// time the pending frame was handed over (LatencyTracer::now())
+	qint64 _pendingTimestamp;
+	/// capture time of the current input and of the pending frame
+	qint64 _captureTime;
+	qint64 _pendingCaptureTime;
+	/// mailbox statistics, queue age in us
+	quint64 _writtenFrames;
+	quint64 _droppedFrames;
+	qint64 _lastQueueAge;
+	qint64 _maxQueueAge;
 };
 
 #endif // LEDEVICEWRAPPER_H
@@ -76,4 +76,15 @@ public:
 	/// @param[out] green The green RGB-component
 	/// @param[out] blue The blue RGB-component
 	static void yuv2rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t & r, uint8_t & g, uint8_t & b);
+
+	///
+	///	Translates an RGB (red, green, blue) color to a YUV (luminance, chrominance, chrominance) color, inverse of yuv2rgb()
+	///
+	/// @param[in] red The red RGB-component
+	/// @param[in] green The green RGB-component
+	/// @param[in] blue The blue RGB-component
+	/// @param[out] y The luminance YUV-component
+	/// @param[out] u The chrominance YUV-component
+	/// @param[out] v The chrominance YUV-component
+	static void rgb2yuv(uint8_t r, uint8_t g, uint8_t b, uint8_t & y, uint8_t & u, uint8_t & v);
 };
@@ -29,7 +29,8 @@ public:
 	/// @param background The color of the image
 	///
 	Image(unsigned width, unsigned height, const Pixel_T background) :
-		_d_ptr(new ImageData<Pixel_T>(width, height, background))
+		_d_ptr(new ImageData<Pixel_T>(width, height, background)),
+		_captureTime(0)
 	{
 	}
 
@@ -40,6 +41,7 @@ public:
 	Image(const Image & other)
 	{
 		_d_ptr = other._d_ptr;
+		_captureTime = other._captureTime;
 	}
 
 	Image& operator=(Image rhs)
@@ -47,17 +49,21 @@ public:
 		// Define assignment operator in terms of the copy constructor
 		// More to read: https://stackoverflow.com/questions/255612/dynamically-allocating-an-array-of-objects?answertab=active#tab-top
 		_d_ptr = rhs._d_ptr;
+		_captureTime = rhs._captureTime;
 		return *this;
 	}
 
 	void swap(Image& s)
 	{
 		std::swap(this->_d_ptr, s._d_ptr);
+		std::swap(this->_captureTime, s._captureTime);
 	}
 
 	Image(Image&& src) noexcept
+		: _captureTime(0)
 	{
 		std::swap(this->_d_ptr, src._d_ptr);
+		std::swap(this->_captureTime, src._captureTime);
 	}
 
 	Image& operator=(Image&& src) noexcept
@@ -178,6 +184,32 @@ public:
 		return _d_ptr->size();
 	}
 
+	///
+	/// Returns true if the pixel data is shared with other images, writing to it would detach (copy) it
+	///
+	bool isShared() const
+	{
+		return _d_ptr.constData()->ref.loadAcquire() > 1;
+	}
+
+	///
+	/// Returns the time the image was captured by a grabber (LatencyTracer::now() in us), 0 if unknown
+	///
+	qint64 captureTime() const
+	{
+		return _captureTime;
+	}
+
+	///
+	/// Set the time the image was captured, used to trace the latency of the frame pipeline
+	///
+	/// @param captureTime The capture time taken from LatencyTracer::now()
+	///
+	void setCaptureTime(qint64 captureTime)
+	{
+		_captureTime = captureTime;
+	}
+
 	///
 	/// Clear the image
 	///
@@ -205,5 +237,8 @@ private:
 
 private:
 	QSharedDataPointer<ImageData<Pixel_T>>  _d_ptr;
+
+	/// capture time in us (LatencyTracer::now()), 0 if unknown
+	qint64 _captureTime;
 };
 
@@ -16,6 +16,16 @@ namespace JsonUtils {
 	///
 	bool readFile(const QString& path, QJsonObject& obj, Logger* log, bool ignError=false);
 
+	///
+	/// @brief read a json file like readFile(), files from the Qt resources (":/...") are parsed just once
+	///        and served from a process wide cache afterwards, as they can't change at runtime
+	/// @param[in]  path     The file path to read
+	/// @param[out] obj      Returns the parsed QJsonObject
+	/// @param[in]  log      The logger of the caller to print errors
+	/// @return              true on success else false
+	///
+	bool readCachedFile(const QString& path, QJsonObject& obj, Logger* log);
+
 	///
 	/// @brief read a schema file and resolve $refs
 	/// @param[in]  path     The file path to read
@@ -56,7 +66,7 @@ namespace JsonUtils {
 	bool parse(const QString& path, const QString& data, QJsonDocument& doc, Logger* log);
 
 	///
-	/// @brief Validate json data against a schema
+	/// @brief Validate json data against a schema, the configured checkers of schemas from the Qt resources are cached
 	/// @param[in]   file     The path/name of json file just used for log messages
 	/// @param[in]   json     The json data
 	/// @param[in]   schemaP  The schema path
@@ -0,0 +1,83 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+
+// Qt includes
+#include <QtGlobal>
+#include <QJsonObject>
+#include <QString>
+
+///
+/// @brief Collects the latency of the frame pipeline stages (capture -> muxer -> update -> smoothing -> LedDevice write).
+///
+/// Every stage owns a lock-free histogram with logarithmic buckets (8 sub-buckets per power of two, <= 12.5% error).
+/// Recording is a single relaxed atomic increment, so it is safe to call from any thread in the hot path.
+/// Timestamps are monotonic microseconds, see now().
+///
+class LatencyTracer
+{
+public:
+	enum Stage
+	{
+		/// Frame captured by a grabber until it reached the PriorityMuxer
+		CAPTURE_TO_MUXER = 0,
+		/// Duration of Hyperion::update()
+		HYPERION_UPDATE,
+		/// Duration of the image to led mapping (ImageProcessor::process)
+		IMAGE_PROCESS,
+		/// Duration of one LinearColorSmoothing output step
+		SMOOTHING,
+		/// Time a frame waited in the LedDevice mailbox
+		DEVICE_QUEUE,
+		/// Duration of LedDevice::updateLeds (including the write)
+		DEVICE_WRITE,
+		/// Frame captured by a grabber until written to the LedDevice
+		END_TO_END,
+		STAGE_COUNT
+	};
+
+	///
+	/// @brief Get the current monotonic time
+	/// @return Time in microseconds
+	///
+	static qint64 now();
+
+	///
+	/// @brief Record a duration for the given stage
+	/// @param stage       The pipeline stage
+	/// @param duration_us The duration in microseconds, negative values are ignored
+	///
+	static void record(Stage stage, qint64 duration_us);
+
+	///
+	/// @brief Record the time elapsed since start_us for the given stage
+	/// @param stage    The pipeline stage
+	/// @param start_us Start time taken from now(), 0 (unknown) is ignored
+	///
+	static void recordSince(Stage stage, qint64 start_us);
+
+	///
+	/// @brief Reset all histograms
+	///
+	static void reset();
+
+	///
+	/// @brief Get count, p50, p95, p99 and max in microseconds of all stages
+	/// @return The statistics per stage
+	///
+	static QJsonObject getStatistics();
+
+	///
+	/// @brief Get all histograms in the Prometheus text exposition format
+	/// @return The metrics text
+	///
+	static QString getPrometheusText();
+
+	///
+	/// @brief Get the name of the stage
+	/// @param stage The pipeline stage
+	/// @return The name in snake case
+	///
+	static const char* stageToString(Stage stage);
+};
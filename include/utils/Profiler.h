@@ -1,51 +1,91 @@
-#include <stdio.h>
-#include <stdarg.h>
-#include <time.h>
-#include <map>
-#include <utils/Logger.h>
-#include <HyperionConfig.h>
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
 
 /*
-The performance (real time) of any function can be tested with the help of profiler.
-The determined times are determined using clock cycles.
+The execution time (monotonic wall time) of any code block can be traced with the help of the profiler.
+The profiler is always compiled and costs a single atomic load per scope while tracing is disabled.
+Tracing is enabled at runtime (JSON-RPC command "tracing", subcommand "start") or at startup with the cmake option -DENABLE_PROFILER=ON.
 
-To do this, compile with the cmake option: -DENABLE_PROFILER=ON
-This header file (utils/Profiler.h) must be included in the respective file that contains the function to be measured
+Every thread records into its own ring buffer, the latest events of all threads are exported
+as Chrome trace event JSON (load it in chrome://tracing or https://ui.perfetto.dev).
 
-The start time is set in a function with the following instructions:
+Trace the enclosing block with its function name:
+PROFILER_BLOCK_EXECUTION_TIME
+Trace the enclosing block with a custom name (string literal):
+PROFILER_SCOPE("ImageProcessor::process")
+Trace between two points of the same thread:
 PROFILER_TIMER_START("test_performance")
-The end point is set as follows:
 PROFILER_TIMER_GET("test_performance")
-
-For more profiler function see the macros listed below
 */
 
-#ifndef ENABLE_PROFILER
-	#error "Profiler is not for production code, enable it via cmake or remove header include"
-#endif
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
 
 // profiler
-#define PROFILER_BLOCK_EXECUTION_TIME Profiler DEBUG_PROFILE__BLOCK__EXECUTION__TIME_messure_object(__FILE__, __FUNCTION__, __LINE__ );
-#define PROFILER_TIMER_START(stopWatchName)   Profiler::TimerStart(stopWatchName, __FILE__, __FUNCTION__, __LINE__);
-#define PROFILER_TIMER_GET(stopWatchName)    Profiler::TimerGetTime(stopWatchName, __FILE__, __FUNCTION__, __LINE__);
-#define PROFILER_TIMER_GET_IF(condition, stopWatchName) { if (condition) {Profiler::TimerGetTime(stopWatchName, __FILE__, __FUNCTION__, __LINE__);} }
+#define PROFILER_SCOPE(name) Profiler::Scope PROFILER_CONCAT(profilerScope_, __LINE__)(name);
+#define PROFILER_BLOCK_EXECUTION_TIME PROFILER_SCOPE(__FUNCTION__)
+#define PROFILER_TIMER_START(stopWatchName)   Profiler::TimerStart(stopWatchName);
+#define PROFILER_TIMER_GET(stopWatchName)    Profiler::TimerGetTime(stopWatchName);
+#define PROFILER_TIMER_GET_IF(condition, stopWatchName) { if (condition) {Profiler::TimerGetTime(stopWatchName);} }
 
 class Profiler
 {
 public:
-	Profiler(const char* sourceFile, const char* func, unsigned int line);
-	~Profiler();
+	///
+	/// @brief Traces the lifetime of the object as complete event, the name has to outlive the trace (string literal)
+	///
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name);
+		~Scope();
+
+	private:
+		const char* _name;
+		qint64 _start;
+	};
+
+	///
+	/// @brief Enable/disable tracing at runtime
+	/// @param enable True to record events
+	///
+	static void setEnabled(bool enable);
+
+	///
+	/// @return True if events are recorded
+	///
+	static bool isEnabled();
+
+	///
+	/// @brief Record a complete event of the current thread
+	/// @param name     Event name, has to outlive the trace (string literal)
+	/// @param start_us Start time (LatencyTracer::now())
+	/// @param dur_us   Duration in microseconds
+	///
+	static void addEvent(const char* name, qint64 start_us, qint64 dur_us);
+
+	///
+	/// @brief Start a named timer of the current thread
+	/// @param stopWatchName Name of the timer, has to outlive the trace (string literal)
+	///
+	static void TimerStart(const char* stopWatchName);
 
-	static void TimerStart(const QString& stopWatchName, const char* sourceFile, const char* func, unsigned int line);
-	static void TimerGetTime(const QString& stopWatchName, const char* sourceFile, const char* func, unsigned int line);
+	///
+	/// @brief Record the time since TimerStart() of the named timer of the current thread
+	/// @param stopWatchName Name of the timer
+	///
+	static void TimerGetTime(const char* stopWatchName);
 
-private:
-	static void initLogger();
+	///
+	/// @brief Drop all recorded events
+	///
+	static void clear();
 
-	static Logger*  _logger;
-	const char*     _file;
-	const char*     _func;
-	unsigned int    _line;
-	unsigned int    _blockId;
-	clock_t         _startTime;
+	///
+	/// @brief Export the recorded events of all threads in the Chrome trace event format
+	/// @return The trace with "traceEvents" array
+	///
+	static QJsonObject getChromeTrace();
 };
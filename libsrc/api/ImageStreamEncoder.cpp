@@ -0,0 +1,30 @@
+#include <api/ImageStreamEncoder.h>
+
+// qt includes
+#include <QImage>
+#include <QBuffer>
+
+ImageStreamEncoder::ImageStreamEncoder(const Image<ColorRgb>& image, int maxWidth)
+	: QObject()
+	, QRunnable()
+	, _image(image)
+	, _maxWidth(maxWidth)
+{
+	setAutoDelete(true);
+}
+
+void ImageStreamEncoder::run()
+{
+	QImage jpgImage((const uint8_t *)_image.memptr(), _image.width(), _image.height(), 3 * _image.width(), QImage::Format_RGB888);
+	if (_maxWidth > 0 && jpgImage.width() > _maxWidth)
+	{
+		jpgImage = jpgImage.scaledToWidth(_maxWidth, Qt::FastTransformation);
+	}
+
+	QByteArray ba;
+	QBuffer buffer(&ba);
+	buffer.open(QIODevice::WriteOnly);
+	jpgImage.save(&buffer, "jpg");
+
+	emit imageEncoded(ba, jpgImage.width(), jpgImage.height());
+}
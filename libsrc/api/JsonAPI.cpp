@@ -10,6 +10,8 @@
 #include <QTimer>
 #include <QHostInfo>
 #include <QMultiMap>
+#include <QThreadPool>
+#include <QMetaMethod>
 
 // hyperion includes
 #include <leddevice/LedDeviceWrapper.h>
@@ -46,6 +48,8 @@
 #include <utils/ColorSys.h>
 #include <utils/Process.h>
 #include <utils/JsonUtils.h>
+#include <utils/LatencyTracer.h>
+#include <utils/Profiler.h>
 
 // bonjour wrapper
 #ifdef ENABLE_AVAHI
@@ -57,6 +61,7 @@
 
 // api includes
 #include <api/JsonCB.h>
+#include <api/ImageStreamEncoder.h>
 
 // auth manager
 #include <hyperion/AuthManager.h>
@@ -74,6 +79,12 @@ JsonAPI::JsonAPI(QString peerAddress, Logger *log, bool localConnection, QObject
 	_jsonCB = new JsonCB(this);
 	_streaming_logging_activated = false;
 	_ledStreamTimer = new QTimer(this);
+	_ledStreamBinary = false;
+	_imageStreamActive = false;
+	_imageStreamBinary = false;
+	_imageEncodePending = false;
+	_imageStreamInterval = 0;
+	_lastImageStreamTime = 0;
 
 	Q_INIT_RESOURCE(JSONRPC_schemas);
 }
@@ -126,15 +137,19 @@ void JsonAPI::handleMessage(const QString &messageString, const QString &httpAut
 	if (message.value("tan") != QJsonValue::Undefined)
 		tan = message["tan"].toInt();
 
+	const QString command = message["command"].toString();
+
+	// high rate commands skip the basic check, their specific schema restricts the command as well
+	const bool fastPath = (command == "color" || command == "image");
+
 	// check basic message
-	if (!JsonUtils::validate(ident, message, ":schema", _log))
+	if (!fastPath && !JsonUtils::validate(ident, message, ":schema", _log))
 	{
 		sendErrorReply("Errors during message validation, please consult the Hyperion Log.", "" /*command*/, tan);
 		return;
 	}
 
 	// check specific message
-	const QString command = message["command"].toString();
 	if (!JsonUtils::validate(ident, message, QString(":schema-%1").arg(command), _log))
 	{
 		sendErrorReply("Errors during specific message validation, please consult the Hyperion Log", command, tan);
@@ -201,6 +216,8 @@ proceed:
 		handleLedDeviceCommand(message, command, tan);
 	else if (command == "inputsource")
 		handleInputSourceCommand(message, command, tan);
+	else if (command == "tracing")
+		handleTracingCommand(message, command, tan);
 
 	// BEGIN | The following commands are deprecated but used to ensure backward compatibility with hyperion Classic remote control
 	else if (command == "clearall")
@@ -333,6 +350,19 @@ void JsonAPI::handleSysInfoCommand(const QJsonObject &, const QString &command,
 
 void JsonAPI::handleServerInfoCommand(const QJsonObject &message, const QString &command, int tan)
 {
+	const QString subcommand = message["subcommand"].toString("");
+	if (subcommand == "latency")
+	{
+		sendSuccessDataReply(QJsonDocument(LatencyTracer::getStatistics()), command + "-" + subcommand, tan);
+		return;
+	}
+	if (subcommand == "latency-reset")
+	{
+		LatencyTracer::reset();
+		sendSuccessReply(command + "-" + subcommand, tan);
+		return;
+	}
+
 	QJsonObject info;
 
 	// collect priority information
@@ -489,6 +519,7 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject &message, const QString
 	}
 
 	ledDevices["available"] = availableLedDevices;
+	ledDevices["statistics"] = _hyperion->getLedDeviceStatistics();
 	info["ledDevices"] = ledDevices;
 
 	QJsonObject grabbers;
@@ -533,6 +564,12 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject &message, const QString
 	}
 
 	info["components"] = component;
+
+	// forwarder connections
+	QJsonObject forwarder;
+	forwarder["json"] = _hyperion->getForwarderStatistics();
+	info["forwarder"] = forwarder;
+
 	info["imageToLedMappingType"] = ImageProcessor::mappingTypeToStr(_hyperion->getLedMappingType());
 
 	// add sessions
@@ -963,8 +1000,19 @@ void JsonAPI::handleLedColorsCommand(const QJsonObject &message, const QString &
 	// max 20 Hz (50ms) interval for streaming (default: 10 Hz (100ms))
 	qint64 streaming_interval = qMax(message["interval"].toInt(100), 50);
 
+	// binary streams are sent as WebSocket binary messages
+	const bool binary = message["format"].toString("json") == "binary";
+	if (binary && !isSignalConnected(QMetaMethod::fromSignal(&JsonAPI::callbackBinaryMessage)))
+	{
+		sendErrorReply("Binary streams are only supported by WebSocket connections", command + "-" + subcommand, tan);
+		return;
+	}
+
 	if (subcommand == "ledstream-start")
 	{
+		_ledStreamBinary = binary;
+		_previousStreamLedValues.clear();
+
 		_streaming_leds_reply["success"] = true;
 		_streaming_leds_reply["command"] = command + "-ledstream-update";
 		_streaming_leds_reply["tan"] = tan;
@@ -996,6 +1044,12 @@ void JsonAPI::handleLedColorsCommand(const QJsonObject &message, const QString &
 	}
 	else if (subcommand == "imagestream-start")
 	{
+		_imageStreamActive = true;
+		_imageStreamBinary = binary;
+		// binary streams are rate limited to 10 Hz by default, JSON streams send every frame unless requested
+		_imageStreamInterval = message.contains("interval") ? streaming_interval : (binary ? 100 : 0);
+		_lastImageStreamTime = 0;
+
 		_streaming_image_reply["success"] = true;
 		_streaming_image_reply["command"] = command + "-imagestream-update";
 		_streaming_image_reply["tan"] = tan;
@@ -1004,6 +1058,7 @@ void JsonAPI::handleLedColorsCommand(const QJsonObject &message, const QString &
 	}
 	else if (subcommand == "imagestream-stop")
 	{
+		_imageStreamActive = false;
 		disconnect(_hyperion, &Hyperion::currentImage, this, 0);
 	}
 	else
@@ -1056,6 +1111,45 @@ void JsonAPI::handleLoggingCommand(const QJsonObject &message, const QString &co
 	}
 }
 
+void JsonAPI::handleTracingCommand(const QJsonObject &message, const QString &command, int tan)
+{
+	const QString subcommand = message["subcommand"].toString("");
+	const QString full_command = command + "-" + subcommand;
+
+	if (!API::isAdminAuthorized())
+	{
+		sendErrorReply("No Authorization", full_command, tan);
+		return;
+	}
+
+	if (subcommand == "start")
+	{
+		Profiler::setEnabled(true);
+		Debug(_log, "tracing started by client %s", QSTRING_CSTR(_peerAddress));
+		sendSuccessReply(full_command, tan);
+	}
+	else if (subcommand == "stop")
+	{
+		Profiler::setEnabled(false);
+		Debug(_log, "tracing stopped by client %s", QSTRING_CSTR(_peerAddress));
+		sendSuccessReply(full_command, tan);
+	}
+	else if (subcommand == "clear")
+	{
+		Profiler::clear();
+		sendSuccessReply(full_command, tan);
+	}
+	else if (subcommand == "get")
+	{
+		// Chrome trace event format, load it in chrome://tracing
+		sendSuccessDataReply(QJsonDocument(Profiler::getChromeTrace()), full_command, tan);
+	}
+	else
+	{
+		sendErrorReply("Unknown or missing subcommand", full_command, tan);
+	}
+}
+
 void JsonAPI::handleProcessingCommand(const QJsonObject &message, const QString &command, int tan)
 {
 	API::setLedMappingType(ImageProcessor::mappingTypeToInt(message["mappingType"].toString("multicolor_mean")));
@@ -1578,6 +1672,17 @@ void JsonAPI::sendErrorReply(const QString &error, const QString &command, int t
 
 void JsonAPI::streamLedcolorsUpdate(const std::vector<ColorRgb> &ledColors)
 {
+	if (_ledStreamBinary)
+	{
+		QByteArray data;
+		encodeLedFrame(ledColors, data);
+		if (!data.isEmpty())
+		{
+			emit callbackBinaryMessage(data);
+		}
+		return;
+	}
+
 	QJsonObject result;
 	QJsonArray leds;
 
@@ -1595,18 +1700,119 @@ void JsonAPI::streamLedcolorsUpdate(const std::vector<ColorRgb> &ledColors)
 
 void JsonAPI::setImage(const Image<ColorRgb> &image)
 {
-	QImage jpgImage((const uint8_t *)image.memptr(), image.width(), image.height(), 3 * image.width(), QImage::Format_RGB888);
-	QByteArray ba;
-	QBuffer buffer(&ba);
-	buffer.open(QIODevice::WriteOnly);
-	jpgImage.save(&buffer, "jpg");
+	// one encode per client at a time, frames in between are skipped
+	if (_imageEncodePending)
+	{
+		return;
+	}
+
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if (now - _lastImageStreamTime < _imageStreamInterval)
+	{
+		return;
+	}
+	_lastImageStreamTime = now;
+	_imageEncodePending = true;
+
+	// binary streams are a preview, downscale them
+	ImageStreamEncoder* encoder = new ImageStreamEncoder(image, _imageStreamBinary ? 320 : 0);
+	connect(encoder, &ImageStreamEncoder::imageEncoded, this, &JsonAPI::handleEncodedImage, Qt::QueuedConnection);
+	QThreadPool::globalInstance()->start(encoder);
+}
+
+void JsonAPI::handleEncodedImage(const QByteArray &jpeg, int width, int height)
+{
+	_imageEncodePending = false;
+	if (!_imageStreamActive)
+	{
+		return;
+	}
+
+	if (_imageStreamBinary)
+	{
+		QByteArray data;
+		data.reserve(5 + jpeg.size());
+		data.append(char(0x03));
+		data.append(char((width >> 8) & 0xFF)).append(char(width & 0xFF));
+		data.append(char((height >> 8) & 0xFF)).append(char(height & 0xFF));
+		data.append(jpeg);
+		emit callbackBinaryMessage(data);
+		return;
+	}
 
 	QJsonObject result;
-	result["image"] = "data:image/jpg;base64," + QString(ba.toBase64());
+	result["image"] = "data:image/jpg;base64," + QString(jpeg.toBase64());
 	_streaming_image_reply["result"] = result;
 	emit callbackMessage(_streaming_image_reply);
 }
 
+void JsonAPI::encodeLedFrame(const std::vector<ColorRgb> &ledColors, QByteArray &data)
+{
+	const int ledCount = static_cast<int>(qMin(ledColors.size(), size_t(0xFFFF)));
+	const int fullSize = 3 + 3 * ledCount;
+
+	auto appendUInt16 = [&data](int value) {
+		data.append(char((value >> 8) & 0xFF)).append(char(value & 0xFF));
+	};
+
+	data.clear();
+	if (_previousStreamLedValues.size() == static_cast<size_t>(ledCount))
+	{
+		data.reserve(fullSize);
+		data.append(char(0x02));
+		appendUInt16(ledCount);
+
+		int i = 0;
+		while (i < ledCount)
+		{
+			int unchanged = 0;
+			while (i < ledCount && unchanged < 0xFFFF && ledColors[i] == _previousStreamLedValues[i])
+			{
+				++unchanged;
+				++i;
+			}
+			if (i == ledCount)
+			{
+				break;
+			}
+
+			const int start = i;
+			while (i < ledCount && i - start < 0xFFFF && !(ledColors[i] == _previousStreamLedValues[i]))
+			{
+				++i;
+			}
+
+			appendUInt16(unchanged);
+			appendUInt16(i - start);
+			data.append(reinterpret_cast<const char*>(&ledColors[start]), 3 * (i - start));
+
+			// the delta does not pay off, send a full frame
+			if (data.size() >= fullSize)
+			{
+				break;
+			}
+		}
+
+		if (data.size() == 3)
+		{
+			// nothing changed
+			data.clear();
+			return;
+		}
+	}
+
+	if (data.isEmpty() || data.size() >= fullSize)
+	{
+		data.clear();
+		data.reserve(fullSize);
+		data.append(char(0x01));
+		appendUInt16(ledCount);
+		data.append(reinterpret_cast<const char*>(ledColors.data()), 3 * ledCount);
+	}
+
+	_previousStreamLedValues.assign(ledColors.begin(), ledColors.begin() + ledCount);
+}
+
 void JsonAPI::incommingLogMessage(const Logger::T_LOG_MESSAGE &msg)
 {
 	QJsonObject result, message;
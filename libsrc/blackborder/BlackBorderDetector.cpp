@@ -4,11 +4,91 @@
 // BlackBorders includes
 #include <blackborder/BlackBorderDetector.h>
 #include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define BLACKBORDER_NEON
+#endif
 
 using namespace hyperion;
 
+namespace {
+
+///
+/// Returns the largest of count values, 16 at a time where SSE2 or NEON is available
+///
+uint8_t maxValue(const uint8_t * data, int count)
+{
+	int i = 0;
+	uint8_t result = 0;
+
+#if defined(__SSE2__)
+	__m128i max = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16)
+	{
+		max = _mm_max_epu8(max, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+	}
+	alignas(16) uint8_t lanes[16];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), max);
+	for (uint8_t lane : lanes)
+	{
+		result = std::max(result, lane);
+	}
+#elif defined(BLACKBORDER_NEON)
+	uint8x16_t max = vdupq_n_u8(0);
+	for (; i + 16 <= count; i += 16)
+	{
+		max = vmaxq_u8(max, vld1q_u8(data + i));
+	}
+	uint8x8_t half = vmax_u8(vget_low_u8(max), vget_high_u8(max));
+	half = vpmax_u8(half, half);
+	half = vpmax_u8(half, half);
+	half = vpmax_u8(half, half);
+	result = vget_lane_u8(half, 0);
+#endif
+
+	for (; i < count; ++i)
+	{
+		result = std::max(result, data[i]);
+	}
+	return result;
+}
+
+///
+/// Raises every value of accumulator to the corresponding value of data, 16 at a time where SSE2 or NEON is available
+///
+void accumulateMax(uint8_t * accumulator, const uint8_t * data, int count)
+{
+	int i = 0;
+
+#if defined(__SSE2__)
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i * target = reinterpret_cast<__m128i*>(accumulator + i);
+		_mm_storeu_si128(target, _mm_max_epu8(_mm_loadu_si128(target), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))));
+	}
+#elif defined(BLACKBORDER_NEON)
+	for (; i + 16 <= count; i += 16)
+	{
+		vst1q_u8(accumulator + i, vmaxq_u8(vld1q_u8(accumulator + i), vld1q_u8(data + i)));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		accumulator[i] = std::max(accumulator[i], data[i]);
+	}
+}
+
+} // namespace
+
 BlackBorderDetector::BlackBorderDetector(double threshold)
 	: _blackborderThreshold(calculateThreshold(threshold))
+	, _planeWidth(0)
+	, _planeHeight(0)
 {
 	// empty
 }
@@ -27,3 +107,80 @@ uint8_t BlackBorderDetector::calculateThreshold(double threshold) const
 
 	return blackborderThreshold;
 }
+
+void BlackBorderDetector::resizePlane(int width, int height)
+{
+	if (width != _planeWidth || height != _planeHeight)
+	{
+		_planeWidth = width;
+		_planeHeight = height;
+		_plane.resize(static_cast<size_t>(width) * height);
+		_columnMax.resize(width);
+	}
+}
+
+bool BlackBorderDetector::findPlaneBorder(int & top, int & bottom, int & left, int & right)
+{
+	top = findSideBorder(Side::TOP, _planeHeight / 3);
+	bottom = findSideBorder(Side::BOTTOM, _planeHeight / 3);
+	if (top < 0 && bottom < 0)
+	{
+		return false;
+	}
+
+	// columns within the content rows, a letterbox must not hide the pillarbox
+	const int rowBegin = top >= 0 ? top : 0;
+	const int rowEnd = _planeHeight - (bottom >= 0 ? bottom : 0);
+	memset(_columnMax.data(), 0, _columnMax.size());
+	for (int row = rowBegin; row < rowEnd; ++row)
+	{
+		accumulateMax(_columnMax.data(), _plane.data() + row * _planeWidth, _planeWidth);
+	}
+
+	left = findSideBorder(Side::LEFT, _planeWidth / 3);
+	right = findSideBorder(Side::RIGHT, _planeWidth / 3);
+	if (left < 0 && right < 0)
+	{
+		return false;
+	}
+	return true;
+}
+
+int BlackBorderDetector::findSideBorder(Side side, int limit) const
+{
+	if (limit <= 0)
+	{
+		// too small to have a border
+		return 0;
+	}
+
+	return firstNonBlackLine(side, 0, limit);
+}
+
+int BlackBorderDetector::firstNonBlackLine(Side side, int begin, int end) const
+{
+	for (int index = begin; index < end; ++index)
+	{
+		if (!isBlackLine(side, index))
+		{
+			return index;
+		}
+	}
+	return -1;
+}
+
+bool BlackBorderDetector::isBlackLine(Side side, int index) const
+{
+	switch (side)
+	{
+	case Side::TOP:
+		return maxValue(_plane.data() + index * _planeWidth, _planeWidth) < _blackborderThreshold;
+	case Side::BOTTOM:
+		return maxValue(_plane.data() + (_planeHeight - 1 - index) * _planeWidth, _planeWidth) < _blackborderThreshold;
+	case Side::LEFT:
+		return _columnMax[index] < _blackborderThreshold;
+	case Side::RIGHT:
+		return _columnMax[_planeWidth - 1 - index] < _blackborderThreshold;
+	}
+	return true;
+}
@@ -1,19 +1,83 @@
 #include "FlatBufferClient.h"
+#include "SharedImageBuffer.h"
 
 // qt
 #include <QTcpSocket>
+#include <QLocalSocket>
 #include <QHostAddress>
 #include <QTimer>
 #include <QRgb>
 
+// stl
+#include <algorithm>
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef HAVE_TURBO_JPEG
+#include <turbojpeg.h>
+#endif
+
+namespace {
+	// initial size of the receive buffer, grows with the largest messages of the client
+	const int INITIAL_RECEIVE_BUFFER_SIZE = 64 * 1024;
+	// alignment of a message start, the largest scalar of hyperion_request.fbs has 4 bytes
+	const quintptr MESSAGE_ALIGNMENT = 4;
+	// number of decoded images kept for reuse
+	const size_t IMAGE_POOL_SIZE = 3;
+	// largest accepted image (8K UHD), guards the allocation against sizes from the network
+	const qint64 MAX_IMAGE_PIXELS = 7680 * 4320;
+	// largest accepted message, a raw image of the largest size plus the message around it
+	const uint32_t MAX_MESSAGE_SIZE = static_cast<uint32_t>(MAX_IMAGE_PIXELS * 3 + 64 * 1024);
+	// the receive buffer holds at most one incomplete message with its header and alignment
+	const int MAX_RECEIVE_BUFFER_SIZE = static_cast<int>(MAX_MESSAGE_SIZE + 4 + MESSAGE_ALIGNMENT);
+	// maximum compression ratio of LZ4
+	const qint64 LZ4_MAX_RATIO = 255;
+
+	bool isValidImageSize(int width, int height)
+	{
+		return width > 0 && height > 0 && qint64(width) * height <= MAX_IMAGE_PIXELS;
+	}
+}
+
 FlatBufferClient::FlatBufferClient(QTcpSocket* socket, int timeout, QObject *parent)
 	: QObject(parent)
 	, _log(Logger::getInstance("FLATBUFSERVER"))
 	, _socket(socket)
 	, _clientAddress("@"+socket->peerAddress().toString())
+	, _localClient(false)
 	, _timeoutTimer(new QTimer(this))
 	, _timeout(timeout * 1000)
 	, _priority()
+	, _receiveBuffer(INITIAL_RECEIVE_BUFFER_SIZE, 0)
+	, _readPos(0)
+	, _writePos(0)
+	, _jpegDecompressor(nullptr)
+{
+	connect(socket, &QTcpSocket::disconnected, this, &FlatBufferClient::disconnected);
+	init();
+}
+
+FlatBufferClient::FlatBufferClient(QLocalSocket* socket, int timeout, QObject *parent)
+	: QObject(parent)
+	, _log(Logger::getInstance("FLATBUFSERVER"))
+	, _socket(socket)
+	, _clientAddress("@local")
+	, _localClient(true)
+	, _timeoutTimer(new QTimer(this))
+	, _timeout(timeout * 1000)
+	, _priority()
+	, _receiveBuffer(INITIAL_RECEIVE_BUFFER_SIZE, 0)
+	, _readPos(0)
+	, _writePos(0)
+	, _jpegDecompressor(nullptr)
+{
+	connect(socket, &QLocalSocket::disconnected, this, &FlatBufferClient::disconnected);
+	init();
+}
+
+void FlatBufferClient::init()
 {
 	// timer setup
 	_timeoutTimer->setSingleShot(true);
@@ -21,33 +85,85 @@ FlatBufferClient::FlatBufferClient(QTcpSocket* socket, int timeout, QObject *par
 	connect(_timeoutTimer, &QTimer::timeout, this, &FlatBufferClient::forceClose);
 
 	// connect socket signals
-	connect(_socket, &QTcpSocket::readyRead, this, &FlatBufferClient::readyRead);
-	connect(_socket, &QTcpSocket::disconnected, this, &FlatBufferClient::disconnected);
+	connect(_socket, &QIODevice::readyRead, this, &FlatBufferClient::readyRead);
+
+	// YUV images are converted in full size
+	_imageResampler.setHorizontalPixelDecimation(1);
+	_imageResampler.setVerticalPixelDecimation(1);
+}
+
+FlatBufferClient::~FlatBufferClient()
+{
+#ifdef HAVE_TURBO_JPEG
+	if (_jpegDecompressor != nullptr)
+	{
+		tjDestroy(_jpegDecompressor);
+	}
+#endif
 }
 
 void FlatBufferClient::readyRead()
 {
 	_timeoutTimer->start();
 
-	_receiveBuffer += _socket->readAll();
+	qint64 available;
+	while ((available = _socket->bytesAvailable()) > 0)
+	{
+		if (_receiveBuffer.size() - _writePos < available)
+		{
+			// a complete message is parsed before the buffer is full, so the buffer does not need to grow beyond the maximum
+			const int unread = _writePos - _readPos;
+			compactReceiveBuffer(static_cast<int>(qMin<qint64>(available, MAX_RECEIVE_BUFFER_SIZE - unread)));
+		}
+
+		const qint64 bytesRead = _socket->read(_receiveBuffer.data() + _writePos, _receiveBuffer.size() - _writePos);
+		if (bytesRead <= 0)
+		{
+			break;
+		}
+		_writePos += static_cast<int>(bytesRead);
+
+		processMessages();
+	}
+}
 
+void FlatBufferClient::processMessages()
+{
 	// check if we can read a header
-	while(_receiveBuffer.size() >= 4)
+	while(_writePos - _readPos >= 4)
 	{
+		const uint8_t* header = reinterpret_cast<const uint8_t*>(_receiveBuffer.constData()) + _readPos;
 		uint32_t messageSize =
-			((_receiveBuffer[0]<<24) & 0xFF000000) |
-			((_receiveBuffer[1]<<16) & 0x00FF0000) |
-			((_receiveBuffer[2]<< 8) & 0x0000FF00) |
-			((_receiveBuffer[3]    ) & 0x000000FF);
+			(uint32_t(header[0]) << 24) |
+			(uint32_t(header[1]) << 16) |
+			(uint32_t(header[2]) <<  8) |
+			(uint32_t(header[3])      );
+
+		// the size is sent by the client, never parse or buffer more than the largest valid message
+		if (messageSize > MAX_MESSAGE_SIZE)
+		{
+			Error(_log, "Message of %u bytes from client %s exceeds the maximum size, closing the connection", messageSize, QSTRING_CSTR(_clientAddress));
+			_readPos = 0;
+			_writePos = 0;
+			forceClose();
+			return;
+		}
 
 		// check if we can read a complete message
-		if((uint32_t) _receiveBuffer.size() < messageSize + 4) return;
+		if (static_cast<uint32_t>(_writePos - _readPos) - 4 < messageSize) break;
+
+		// the message is parsed in place, realign the unread data if a client sends unpadded messages
+		const uint8_t* msgData = header + 4;
+		if (reinterpret_cast<quintptr>(msgData) % MESSAGE_ALIGNMENT != 0)
+		{
+			const quintptr base = reinterpret_cast<quintptr>(_receiveBuffer.constData()) + 4;
+			compactReceiveBuffer(0, static_cast<int>((MESSAGE_ALIGNMENT - base % MESSAGE_ALIGNMENT) % MESSAGE_ALIGNMENT));
+			continue;
+		}
 
-		// extract message only and remove header + msg from buffer :: QByteArray::remove() does not return the removed data
-		const QByteArray msg = _receiveBuffer.mid(4, messageSize);
-		_receiveBuffer.remove(0, messageSize + 4);
+		// the message stays valid until the next read from the socket
+		_readPos += messageSize + 4;
 
-		const auto* msgData = reinterpret_cast<const uint8_t*>(msg.constData());
 		flatbuffers::Verifier verifier(msgData, messageSize);
 
 		if (hyperionnet::VerifyRequestBuffer(verifier))
@@ -58,6 +174,31 @@ void FlatBufferClient::readyRead()
 		}
 		sendErrorReply("Unable to parse message");
 	}
+
+	// everything consumed, start at the front again without moving data
+	if (_readPos == _writePos)
+	{
+		_readPos = 0;
+		_writePos = 0;
+	}
+}
+
+void FlatBufferClient::compactReceiveBuffer(int minFree, int offset)
+{
+	const int unread = _writePos - _readPos;
+	const int required = offset + unread + minFree;
+	if (_receiveBuffer.size() < required)
+	{
+		// grow geometrically up to the maximum, the buffer is reused for the lifetime of the client
+		_receiveBuffer.resize(qMax(required, qMin(2 * _receiveBuffer.size(), MAX_RECEIVE_BUFFER_SIZE)));
+	}
+
+	if (_readPos != offset && unread > 0)
+	{
+		memmove(_receiveBuffer.data() + offset, _receiveBuffer.constData() + _readPos, unread);
+	}
+	_readPos = offset;
+	_writePos = offset + unread;
 }
 
 void FlatBufferClient::forceClose()
@@ -130,7 +271,9 @@ void FlatBufferClient::handleRegisterCommand(const hyperionnet::Register *regReq
 	_priority = regReq->priority();
 	emit registerGlobalInput(_priority, hyperion::COMP_FLATBUFSERVER, regReq->origin()->c_str()+_clientAddress);
 
-	auto reply = hyperionnet::CreateReplyDirect(_builder, nullptr, -1, (_priority ? _priority : -1));
+	// let the client know which compressed image types it may send
+	const std::vector<uint8_t> imageTypes = supportedImageTypes();
+	auto reply = hyperionnet::CreateReplyDirect(_builder, nullptr, -1, (_priority ? _priority : -1), &imageTypes);
 	_builder.Finish(reply);
 
 	// send reply
@@ -144,29 +287,213 @@ void FlatBufferClient::handleImageCommand(const hyperionnet::Image *image)
 	// extract parameters
 	int duration = image->duration();
 
-	const void* reqPtr;
-	if ((reqPtr = image->data_as_RawImage()) != nullptr)
+	std::string error;
+	const Image<ColorRgb>* imageDest = decodeImage(image, error);
+	if (imageDest != nullptr)
 	{
-		const auto *img = static_cast<const hyperionnet::RawImage*>(reqPtr);
-		const auto & imageData = img->data();
-		const int width = img->width();
-		const int height = img->height();
+		emit setGlobalInputImage(_priority, *imageDest, duration);
+	}
+	else if (!error.empty())
+	{
+		sendErrorReply(error);
+		return;
+	}
 
-		if ((int) imageData->size() != width*height*3)
+	// send reply
+	sendSuccessReply();
+}
+
+Image<ColorRgb>* FlatBufferClient::decodeImage(const hyperionnet::Image *image, std::string & error)
+{
+	switch (image->data_type())
+	{
+		case hyperionnet::ImageType_RawImage:
 		{
-			sendErrorReply("Size of image data does not match with the width and height");
-			return;
+			const auto *img = image->data_as_RawImage();
+			const auto & imageData = img->data();
+			const int width = img->width();
+			const int height = img->height();
+
+			if (imageData == nullptr || !isValidImageSize(width, height) || qint64(imageData->size()) != qint64(width)*height*3)
+			{
+				error = "Size of image data does not match with the width and height";
+				return nullptr;
+			}
+
+			Image<ColorRgb>& imageDest = acquireImage(width, height);
+			memcpy(imageDest.memptr(), imageData->data(), imageData->size());
+			return &imageDest;
+		}
+
+		case hyperionnet::ImageType_YuvImage:
+		{
+			const auto *img = image->data_as_YuvImage();
+			const auto & imageData = img->data();
+			const int width = img->width();
+			const int height = img->height();
+
+			if (imageData == nullptr || !isValidImageSize(width, height) || (width % 2) != 0 || (height % 2) != 0 || qint64(imageData->size()) != qint64(width)*height*3/2)
+			{
+				error = "Size of YUV image data does not match with the (even) width and height";
+				return nullptr;
+			}
+
+			const PixelFormat pixelFormat = (img->format() == hyperionnet::YuvFormat_I420) ? PixelFormat::I420 : PixelFormat::NV12;
+			Image<ColorRgb>& imageDest = acquireImage(width, height);
+			_imageResampler.processImage(imageData->data(), width, height, width, pixelFormat, imageDest);
+			return &imageDest;
+		}
+
+#ifdef HAVE_LZ4
+		case hyperionnet::ImageType_Lz4Image:
+		{
+			const auto *img = image->data_as_Lz4Image();
+			const auto & imageData = img->data();
+			const int width = img->width();
+			const int height = img->height();
+
+			// the decompressed size can not exceed the maximum compression ratio of the received data
+			const qint64 size = qint64(width) * height * 3;
+			if (imageData == nullptr || !isValidImageSize(width, height) || size > LZ4_MAX_RATIO * qint64(imageData->size()))
+			{
+				error = "Invalid LZ4 image";
+				return nullptr;
+			}
+
+			Image<ColorRgb>& imageDest = acquireImage(width, height);
+			const int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(imageData->data()), reinterpret_cast<char*>(imageDest.memptr()), static_cast<int>(imageData->size()), static_cast<int>(size));
+			if (decoded != size)
+			{
+				error = "Size of decompressed LZ4 image data does not match with the width and height";
+				return nullptr;
+			}
+			return &imageDest;
 		}
+#endif
 
-		Image<ColorRgb> imageDest(width, height);
-		memmove(imageDest.memptr(), imageData->data(), imageData->size());
-		emit setGlobalInputImage(_priority, imageDest, duration);
+#ifdef HAVE_TURBO_JPEG
+		case hyperionnet::ImageType_JpegImage:
+		{
+			const auto & imageData = image->data_as_JpegImage()->data();
+			if (imageData == nullptr)
+			{
+				error = "Invalid JPEG image";
+				return nullptr;
+			}
+
+			if (_jpegDecompressor == nullptr)
+			{
+				_jpegDecompressor = tjInitDecompress();
+			}
+
+			int width = 0;
+			int height = 0;
+			int subsamp = 0;
+			unsigned char* jpegData = const_cast<unsigned char*>(imageData->data());
+			if (tjDecompressHeader2(_jpegDecompressor, jpegData, imageData->size(), &width, &height, &subsamp) != 0)
+			{
+				error = std::string("Unable to read JPEG header: ") + tjGetErrorStr();
+				return nullptr;
+			}
+			if (!isValidImageSize(width, height))
+			{
+				error = "Size of JPEG image is invalid or too large";
+				return nullptr;
+			}
+
+			Image<ColorRgb>& imageDest = acquireImage(width, height);
+			if (tjDecompress2(_jpegDecompressor, jpegData, imageData->size(), reinterpret_cast<unsigned char*>(imageDest.memptr()), width, 0, height, TJPF_RGB, TJFLAG_FASTDCT) != 0)
+			{
+				error = std::string("Unable to decompress JPEG image: ") + tjGetErrorStr();
+				return nullptr;
+			}
+			return &imageDest;
+		}
+#endif
+
+		case hyperionnet::ImageType_SharedImage:
+		{
+			if (!_localClient)
+			{
+				error = "Shared memory images are only accepted from local clients";
+				return nullptr;
+			}
+
+			// the grabber creates a new shared memory object when the image size grows
+			const QString key = QString::fromStdString(image->data_as_SharedImage()->key()->str());
+			if (_sharedImage == nullptr || _sharedImage->key() != key || !_sharedImage->isValid())
+			{
+				_sharedImage.reset(new SharedImageBuffer(key));
+				if (!_sharedImage->attach())
+				{
+					_sharedImage.reset();
+					error = "Unable to attach to the shared memory " + key.toStdString();
+					return nullptr;
+				}
+			}
+
+			int width = 0;
+			int height = 0;
+			const uint8_t* data = nullptr;
+			if (!_sharedImage->takeLatest(width, height, data))
+			{
+				// already taken with a previous message
+				return nullptr;
+			}
+
+			// the only copy, the grabber reuses the slot two frames later
+			Image<ColorRgb>& imageDest = acquireImage(width, height);
+			memcpy(imageDest.memptr(), data, imageDest.size());
+			return &imageDest;
+		}
+
+		default:
+			error = "Image type not supported by the server";
+			return nullptr;
 	}
+}
 
-	// send reply
-	sendSuccessReply();
+Image<ColorRgb>& FlatBufferClient::acquireImage(int width, int height)
+{
+	// decode into a pooled image which is no longer referenced by the receivers
+	auto pooled = std::find_if(_imagePool.begin(), _imagePool.end(), [](const Image<ColorRgb>& image) { return !image.isShared(); });
+	if (pooled == _imagePool.end())
+	{
+		if (_imagePool.size() < IMAGE_POOL_SIZE)
+		{
+			_imagePool.emplace_back(width, height);
+			pooled = _imagePool.end() - 1;
+		}
+		else
+		{
+			// all images are still in use, leave the oldest one to its receivers
+			std::rotate(_imagePool.begin(), _imagePool.begin() + 1, _imagePool.end());
+			_imagePool.back() = Image<ColorRgb>(width, height);
+			pooled = _imagePool.end() - 1;
+		}
+	}
+
+	pooled->resize(width, height);
+	return *pooled;
 }
 
+std::vector<uint8_t> FlatBufferClient::supportedImageTypes() const
+{
+	std::vector<uint8_t> imageTypes { hyperionnet::ImageType_RawImage, hyperionnet::ImageType_YuvImage };
+#ifdef HAVE_LZ4
+	imageTypes.push_back(hyperionnet::ImageType_Lz4Image);
+#endif
+#ifdef HAVE_TURBO_JPEG
+	imageTypes.push_back(hyperionnet::ImageType_JpegImage);
+#endif
+#ifndef _WIN32
+	if (_localClient)
+	{
+		imageTypes.push_back(hyperionnet::ImageType_SharedImage);
+	}
+#endif
+	return imageTypes;
+}
 
 void FlatBufferClient::handleClearCommand(const hyperionnet::Clear *clear)
 {
@@ -195,7 +522,11 @@ void FlatBufferClient::sendMessage()
 	uint8_t sizeData[] = {uint8_t(size >> 24), uint8_t(size >> 16), uint8_t(size >> 8), uint8_t(size)};
 	_socket->write((const char *) sizeData, sizeof(sizeData));
 	_socket->write((const char *)buffer, size);
-	_socket->flush();
+
+	if (_localClient)
+		static_cast<QLocalSocket*>(_socket)->flush();
+	else
+		static_cast<QTcpSocket*>(_socket)->flush();
 }
 
 void FlatBufferClient::sendSuccessReply()
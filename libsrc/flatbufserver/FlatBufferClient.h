@@ -5,13 +5,20 @@
 #include <utils/Image.h>
 #include <utils/ColorRgb.h>
 #include <utils/Components.h>
+#include <utils/ImageResampler.h>
 
 // flatbuffer FBS
 #include "hyperion_reply_generated.h"
 #include "hyperion_request_generated.h"
 
+// stl
+#include <memory>
+
+class QIODevice;
 class QTcpSocket;
+class QLocalSocket;
 class QTimer;
+class SharedImageBuffer;
 
 namespace flatbuf {
 	class HyperionRequest;
@@ -32,6 +39,15 @@ public:
 	///
 	explicit FlatBufferClient(QTcpSocket* socket, int timeout, QObject *parent = nullptr);
 
+	///
+	/// @brief Construct a client of the local socket, which may also send images by shared memory
+	/// @param socket   The local socket
+	/// @param timeout  The timeout when a client is automatically disconnected and the priority unregistered
+	/// @param parent   The parent
+	///
+	explicit FlatBufferClient(QLocalSocket* socket, int timeout, QObject *parent = nullptr);
+	~FlatBufferClient() override;
+
 signals:
 	///
 	/// @brief forward register data to HyperionDaemon
@@ -81,6 +97,11 @@ private slots:
 	void disconnected();
 
 private:
+	///
+	/// @brief Setup the timeout timer and connect the socket
+	///
+	void init();
+
 	///
 	/// @brief Handle the received message
 	///
@@ -103,6 +124,27 @@ private:
 	///
 	void handleImageCommand(const hyperionnet::Image *image);
 
+	///
+	/// @brief Decode the payload of an Image message
+	/// @param image      The incoming image
+	/// @param[out] error Reason if the image could not be decoded
+	/// @return The decoded image of the pool, nullptr on error or if there is no new image
+	///
+	Image<ColorRgb>* decodeImage(const hyperionnet::Image *image, std::string & error);
+
+	///
+	/// @brief Get an image of the pool which is no longer referenced by the receivers
+	/// @param width   Width of the image
+	/// @param height  Height of the image
+	/// @return The image, valid until the next call
+	///
+	Image<ColorRgb>& acquireImage(int width, int height);
+
+	///
+	/// @return The ImageType values this client is able to decode
+	///
+	std::vector<uint8_t> supportedImageTypes() const;
+
 	///
 	/// @brief Handle clear command
 	///
@@ -110,6 +152,18 @@ private:
 	///
 	void handleClearCommand(const hyperionnet::Clear *clear);
 
+	///
+	/// @brief Parse all complete messages of the receive buffer in place
+	///
+	void processMessages();
+
+	///
+	/// @brief Move the unread data of the receive buffer to its front and grow it if needed
+	/// @param minFree  Free space required behind the unread data
+	/// @param offset   Start position of the unread data afterwards (used to align messages)
+	///
+	void compactReceiveBuffer(int minFree, int offset = 0);
+
 	///
 	/// Send handle not implemented
 	///
@@ -134,13 +188,30 @@ private:
 
 private:
 	Logger *_log;
-	QTcpSocket *_socket;
+	QIODevice *_socket;
 	const QString _clientAddress;
+	/// connected through the local socket
+	const bool _localClient;
 	QTimer *_timeoutTimer;
 	int _timeout;
 	int _priority;
 
+	/// receive buffer, unread data is between _readPos and _writePos
 	QByteArray _receiveBuffer;
+	int _readPos;
+	int _writePos;
+
+	/// decoded images, reused as soon as the receivers released them
+	std::vector<Image<ColorRgb>> _imagePool;
+
+	/// converts YuvImage payloads
+	ImageResampler _imageResampler;
+
+	/// turbojpeg handle, created with the first JpegImage
+	void* _jpegDecompressor;
+
+	/// shared memory of the last SharedImage
+	std::unique_ptr<SharedImageBuffer> _sharedImage;
 
 	// Flatbuffers builder
 	flatbuffers::FlatBufferBuilder _builder;
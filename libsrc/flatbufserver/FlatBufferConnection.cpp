@@ -3,21 +3,48 @@
 
 // Qt includes
 #include <QRgb>
+#include <QHostAddress>
+#include <QCoreApplication>
+
+// hyperion util
+#include <utils/ColorSys.h>
 
 // flatbuffer includes
 #include <flatbufserver/FlatBufferConnection.h>
+#include <flatbufserver/FlatBufferServer.h>
+#include "SharedImageBuffer.h"
 
 // flatbuffer FBS
 #include "hyperion_reply_generated.h"
 #include "hyperion_request_generated.h"
 
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef HAVE_TURBO_JPEG
+#include <turbojpeg.h>
+#endif
+
+namespace {
+	// servers without image_types in the register reply accept raw images only
+	const uint32_t RAW_IMAGE_TYPES = 1u << hyperionnet::ImageType_RawImage;
+}
+
 FlatBufferConnection::FlatBufferConnection(const QString& origin, const QString & address, int priority, bool skipReply)
 	: _socket()
+	, _localSocket()
+	, _localHost(false)
 	, _origin(origin)
 	, _priority(priority)
 	, _prevSocketState(QAbstractSocket::UnconnectedState)
 	, _log(Logger::getInstance("FLATBUFCONN"))
 	, _registered(false)
+	, _imageEncoding(ImageEncoding::RAW)
+	, _jpegQuality(75)
+	, _serverImageTypes(RAW_IMAGE_TYPES)
+	, _jpegCompressor(nullptr)
+	, _sharedImageGeneration(0)
 {
 	QStringList parts = address.split(":");
 	if (parts.size() != 2)
@@ -33,8 +60,10 @@ FlatBufferConnection::FlatBufferConnection(const QString& origin, const QString
 		throw std::runtime_error(QString("FLATBUFCONNECTION ERROR: Unable to parse the port (%1)").arg(parts[1]).toStdString());
 	}
 
-	if(!skipReply)
-		connect(&_socket, &QTcpSocket::readyRead, this, &FlatBufferConnection::readData, Qt::UniqueConnection);
+	// a server on the same host is connected through its local socket
+	_localHost = (_host == "localhost" || QHostAddress(_host).isLoopback());
+
+	setSkipReply(skipReply);
 
 	// init connect
 	Info(_log, "Connecting to Hyperion: %s:%d", _host.toStdString().c_str(), _port);
@@ -51,11 +80,19 @@ FlatBufferConnection::~FlatBufferConnection()
 {
 	_timer.stop();
 	_socket.close();
+	_localSocket.close();
+
+#ifdef HAVE_TURBO_JPEG
+	if (_jpegCompressor != nullptr)
+	{
+		tjDestroy(_jpegCompressor);
+	}
+#endif
 }
 
 void FlatBufferConnection::readData()
 {
-	_receiveBuffer += _socket.readAll();
+	_receiveBuffer += (_localSocket.state() != QLocalSocket::UnconnectedState) ? _localSocket.readAll() : _socket.readAll();
 
 	// check if we can read a header
 	while(_receiveBuffer.size() >= 4)
@@ -88,9 +125,59 @@ void FlatBufferConnection::readData()
 void FlatBufferConnection::setSkipReply(bool skip)
 {
 	if(skip)
+	{
 		disconnect(&_socket, &QTcpSocket::readyRead, 0, 0);
+		disconnect(&_localSocket, &QLocalSocket::readyRead, 0, 0);
+	}
 	else
+	{
 		connect(&_socket, &QTcpSocket::readyRead, this, &FlatBufferConnection::readData, Qt::UniqueConnection);
+		connect(&_localSocket, &QLocalSocket::readyRead, this, &FlatBufferConnection::readData, Qt::UniqueConnection);
+	}
+}
+
+void FlatBufferConnection::setImageEncoding(ImageEncoding encoding, int jpegQuality)
+{
+	_imageEncoding = encoding;
+	_jpegQuality = qBound(1, jpegQuality, 100);
+}
+
+FlatBufferConnection::ImageEncoding FlatBufferConnection::parseImageEncoding(const QString& encoding)
+{
+	const QString name = encoding.toLower();
+	if (name == "nv12")
+		return ImageEncoding::NV12;
+	if (name == "lz4")
+		return ImageEncoding::LZ4;
+	if (name == "jpeg" || name == "jpg")
+		return ImageEncoding::JPEG;
+	return ImageEncoding::RAW;
+}
+
+FlatBufferConnection::ImageEncoding FlatBufferConnection::imageEncodingFor(const Image<ColorRgb> &image) const
+{
+	switch (_imageEncoding)
+	{
+		case ImageEncoding::NV12:
+			if ((_serverImageTypes & (1u << hyperionnet::ImageType_YuvImage)) && image.width() % 2 == 0 && image.height() % 2 == 0)
+				return ImageEncoding::NV12;
+			break;
+#ifdef HAVE_LZ4
+		case ImageEncoding::LZ4:
+			if (_serverImageTypes & (1u << hyperionnet::ImageType_Lz4Image))
+				return ImageEncoding::LZ4;
+			break;
+#endif
+#ifdef HAVE_TURBO_JPEG
+		case ImageEncoding::JPEG:
+			if (_serverImageTypes & (1u << hyperionnet::ImageType_JpegImage))
+				return ImageEncoding::JPEG;
+			break;
+#endif
+		default:
+			break;
+	}
+	return ImageEncoding::RAW;
 }
 
 void FlatBufferConnection::setRegister(const QString& origin, int priority)
@@ -99,18 +186,7 @@ void FlatBufferConnection::setRegister(const QString& origin, int priority)
 	auto req = hyperionnet::CreateRequest(_builder, hyperionnet::Command_Register, registerReq.Union());
 
 	_builder.Finish(req);
-	uint32_t size = _builder.GetSize();
-	const uint8_t header[] = {
-		uint8_t((size >> 24) & 0xFF),
-		uint8_t((size >> 16) & 0xFF),
-		uint8_t((size >>  8) & 0xFF),
-		uint8_t((size	  ) & 0xFF)};
-
-	// write message
-	int count = 0;
-	count += _socket.write(reinterpret_cast<const char *>(header), 4);
-	count += _socket.write(reinterpret_cast<const char *>(_builder.GetBufferPointer()), size);
-	_socket.flush();
+	writeMessage(_builder.GetBufferPointer(), _builder.GetSize());
 	_builder.Clear();
 }
 
@@ -126,9 +202,104 @@ void FlatBufferConnection::setColor(const ColorRgb & color, int priority, int du
 
 void FlatBufferConnection::setImage(const Image<ColorRgb> &image)
 {
-	auto imgData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(image.memptr()), image.size());
-	auto rawImg = hyperionnet::CreateRawImage(_builder, imgData, image.width(), image.height());
-	auto imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_RawImage, rawImg.Union(), -1);
+	const int width = image.width();
+	const int height = image.height();
+
+	flatbuffers::Offset<hyperionnet::Image> imageReq;
+	if (writeSharedImage(image))
+	{
+		// the server takes the image from shared memory
+		auto sharedImg = hyperionnet::CreateSharedImage(_builder, _builder.CreateString(QSTRING_CSTR(_sharedImage->key())));
+		imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_SharedImage, sharedImg.Union(), -1);
+	}
+	else
+	{
+		switch (imageEncodingFor(image))
+		{
+			case ImageEncoding::NV12:
+			{
+				// convert directly into the message, chroma is averaged over 2x2 pixels
+				uint8_t* yPlane = nullptr;
+				auto imgData = _builder.CreateUninitializedVector(size_t(width) * height * 3 / 2, &yPlane);
+				uint8_t* uvPlane = yPlane + size_t(width) * height;
+				uint8_t u, v;
+
+				for (int y = 0; y < height; y += 2)
+				{
+					const ColorRgb* row0 = image.memptr() + size_t(y) * width;
+					const ColorRgb* row1 = row0 + width;
+					uint8_t* y0 = yPlane + size_t(y) * width;
+					uint8_t* y1 = y0 + width;
+					uint8_t* uv = uvPlane + size_t(y / 2) * width;
+
+					for (int x = 0; x < width; x += 2)
+					{
+						ColorSys::rgb2yuv(row0[x].red, row0[x].green, row0[x].blue, y0[x], u, v);
+						ColorSys::rgb2yuv(row0[x+1].red, row0[x+1].green, row0[x+1].blue, y0[x+1], u, v);
+						ColorSys::rgb2yuv(row1[x].red, row1[x].green, row1[x].blue, y1[x], u, v);
+						ColorSys::rgb2yuv(row1[x+1].red, row1[x+1].green, row1[x+1].blue, y1[x+1], u, v);
+
+						uint8_t luma;
+						ColorSys::rgb2yuv(
+							uint8_t((row0[x].red   + row0[x+1].red   + row1[x].red   + row1[x+1].red   + 2) >> 2),
+							uint8_t((row0[x].green + row0[x+1].green + row1[x].green + row1[x+1].green + 2) >> 2),
+							uint8_t((row0[x].blue  + row0[x+1].blue  + row1[x].blue  + row1[x+1].blue  + 2) >> 2),
+							luma, uv[x], uv[x+1]);
+					}
+				}
+
+				auto yuvImg = hyperionnet::CreateYuvImage(_builder, imgData, width, height, hyperionnet::YuvFormat_NV12);
+				imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_YuvImage, yuvImg.Union(), -1);
+			}
+			break;
+#ifdef HAVE_LZ4
+			case ImageEncoding::LZ4:
+			{
+				const int size = static_cast<int>(image.size());
+				_encodeBuffer.resize(LZ4_compressBound(size));
+				const int compressed = LZ4_compress_default(reinterpret_cast<const char*>(image.memptr()), reinterpret_cast<char*>(_encodeBuffer.data()), size, static_cast<int>(_encodeBuffer.size()));
+
+				auto imgData = _builder.CreateVector(_encodeBuffer.data(), compressed);
+				auto lz4Img = hyperionnet::CreateLz4Image(_builder, imgData, width, height);
+				imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_Lz4Image, lz4Img.Union(), -1);
+			}
+			break;
+#endif
+#ifdef HAVE_TURBO_JPEG
+			case ImageEncoding::JPEG:
+			{
+				if (_jpegCompressor == nullptr)
+				{
+					_jpegCompressor = tjInitCompress();
+				}
+
+				_encodeBuffer.resize(tjBufSize(width, height, TJSAMP_420));
+				unsigned char* jpegData = _encodeBuffer.data();
+				unsigned long jpegSize = _encodeBuffer.size();
+				if (tjCompress2(_jpegCompressor, const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(image.memptr())), width, 0, height, TJPF_RGB,
+								&jpegData, &jpegSize, TJSAMP_420, _jpegQuality, TJFLAG_FASTDCT | TJFLAG_NOREALLOC) != 0)
+				{
+					Error(_log, "Unable to compress JPEG image: %s", tjGetErrorStr());
+					_builder.Clear();
+					return;
+				}
+
+				auto imgData = _builder.CreateVector(jpegData, jpegSize);
+				auto jpegImg = hyperionnet::CreateJpegImage(_builder, imgData);
+				imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_JpegImage, jpegImg.Union(), -1);
+			}
+			break;
+#endif
+			default:
+			{
+				auto imgData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(image.memptr()), image.size());
+				auto rawImg = hyperionnet::CreateRawImage(_builder, imgData, width, height);
+				imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_RawImage, rawImg.Union(), -1);
+			}
+			break;
+		}
+	}
+
 	auto req = hyperionnet::CreateRequest(_builder,hyperionnet::Command_Image,imageReq.Union());
 
 	_builder.Finish(req);
@@ -136,6 +307,27 @@ void FlatBufferConnection::setImage(const Image<ColorRgb> &image)
 	_builder.Clear();
 }
 
+bool FlatBufferConnection::writeSharedImage(const Image<ColorRgb> &image)
+{
+	if (_localSocket.state() != QLocalSocket::ConnectedState || !(_serverImageTypes & (1u << hyperionnet::ImageType_SharedImage)))
+		return false;
+
+	// a new shared memory object for larger images, the server attaches to it with the next message
+	if (_sharedImage == nullptr || _sharedImage->capacity() < image.size())
+	{
+		_sharedImage.reset(new SharedImageBuffer(QString("hyperion-%1-%2").arg(QCoreApplication::applicationPid()).arg(++_sharedImageGeneration)));
+		if (!_sharedImage->create(image.size()))
+		{
+			Warning(_log, "Unable to create shared memory, images are sent through the socket");
+			_serverImageTypes &= ~(1u << hyperionnet::ImageType_SharedImage);
+			_sharedImage.reset();
+			return false;
+		}
+	}
+
+	return _sharedImage->write(image);
+}
+
 void FlatBufferConnection::clear(int priority)
 {
 	auto clearReq = hyperionnet::CreateClear(_builder, priority);
@@ -154,33 +346,45 @@ void FlatBufferConnection::clearAll()
 void FlatBufferConnection::connectToHost()
 {
 	// try connection only when
-	if (_socket.state() == QAbstractSocket::UnconnectedState)
-	   _socket.connectToHost(_host, _port);
+	if (socketState() != QAbstractSocket::UnconnectedState)
+		return;
+
+	// prefer the local socket, the server may be older or not running on this host
+	if (_localHost)
+	{
+		_localSocket.connectToServer(FlatBufferServer::localServerName(_port));
+		if (_localSocket.waitForConnected(100))
+			return;
+		_localSocket.abort();
+	}
+	_socket.connectToHost(_host, _port);
 }
 
 void FlatBufferConnection::sendMessage(const uint8_t* buffer, uint32_t size)
 {
 	// print out connection message only when state is changed
-	if (_socket.state() != _prevSocketState )
+	const QAbstractSocket::SocketState state = socketState();
+	if (state != _prevSocketState )
 	{
 		_registered = false;
-		switch (_socket.state() )
+		_serverImageTypes = RAW_IMAGE_TYPES;
+		switch (state)
 		{
 			case QAbstractSocket::UnconnectedState:
 				Info(_log, "No connection to Hyperion: %s:%d", _host.toStdString().c_str(), _port);
 				break;
 			case QAbstractSocket::ConnectedState:
-				Info(_log, "Connected to Hyperion: %s:%d", _host.toStdString().c_str(), _port);
+				Info(_log, "Connected to Hyperion: %s:%d%s", _host.toStdString().c_str(), _port, (_localSocket.state() == QLocalSocket::ConnectedState) ? " (local socket)" : "");
 				break;
 			default:
 				Debug(_log, "Connecting to Hyperion: %s:%d", _host.toStdString().c_str(), _port);
 				break;
 	  }
-	  _prevSocketState = _socket.state();
+	  _prevSocketState = state;
 	}
 
 
-	if (_socket.state() != QAbstractSocket::ConnectedState)
+	if (state != QAbstractSocket::ConnectedState)
 		return;
 
 	if(!_registered)
@@ -189,6 +393,11 @@ void FlatBufferConnection::sendMessage(const uint8_t* buffer, uint32_t size)
 		return;
 	}
 
+	writeMessage(buffer, size);
+}
+
+void FlatBufferConnection::writeMessage(const uint8_t* buffer, uint32_t size)
+{
 	const uint8_t header[] = {
 		uint8_t((size >> 24) & 0xFF),
 		uint8_t((size >> 16) & 0xFF),
@@ -196,10 +405,26 @@ void FlatBufferConnection::sendMessage(const uint8_t* buffer, uint32_t size)
 		uint8_t((size	  ) & 0xFF)};
 
 	// write message
-	int count = 0;
-	count += _socket.write(reinterpret_cast<const char *>(header), 4);
-	count += _socket.write(reinterpret_cast<const char *>(buffer), size);
-	_socket.flush();
+	if (_localSocket.state() == QLocalSocket::ConnectedState)
+	{
+		_localSocket.write(reinterpret_cast<const char *>(header), 4);
+		_localSocket.write(reinterpret_cast<const char *>(buffer), size);
+		_localSocket.flush();
+	}
+	else
+	{
+		_socket.write(reinterpret_cast<const char *>(header), 4);
+		_socket.write(reinterpret_cast<const char *>(buffer), size);
+		_socket.flush();
+	}
+}
+
+QAbstractSocket::SocketState FlatBufferConnection::socketState() const
+{
+	// the states of QLocalSocket match with the ones of QAbstractSocket
+	if (_localSocket.state() != QLocalSocket::UnconnectedState)
+		return static_cast<QAbstractSocket::SocketState>(_localSocket.state());
+	return _socket.state();
 }
 
 bool FlatBufferConnection::parseReply(const hyperionnet::Reply *reply)
@@ -219,8 +444,21 @@ bool FlatBufferConnection::parseReply(const hyperionnet::Reply *reply)
 		if (registered == -1 || registered != _priority)
 			_registered = false;
 		else
+		{
 			_registered = true;
 
+			// image types the server is able to decode
+			_serverImageTypes = RAW_IMAGE_TYPES;
+			if (reply->image_types() != nullptr)
+			{
+				for (const uint8_t type : *reply->image_types())
+				{
+					if (type < 32)
+						_serverImageTypes |= 1u << type;
+				}
+			}
+		}
+
 		return true;
 	}
 	else
@@ -15,10 +15,13 @@
 #include <QJsonObject>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
 
 FlatBufferServer::FlatBufferServer(const QJsonDocument& config, QObject* parent)
 	: QObject(parent)
 	, _server(new QTcpServer(this))
+	, _localServer(new QLocalServer(this))
 	, _log(Logger::getInstance("FLATBUFSERVER"))
 	, _timeout(5000)
 	, _config(config)
@@ -32,10 +35,18 @@ FlatBufferServer::~FlatBufferServer()
 	delete _server;
 }
 
+QString FlatBufferServer::localServerName(quint16 port)
+{
+	return QString("hyperion-flatbuffer-%1").arg(port);
+}
+
 void FlatBufferServer::initServer()
 {
 	_netOrigin = NetOrigin::getInstance();
 	connect(_server, &QTcpServer::newConnection, this, &FlatBufferServer::newConnection);
+	connect(_localServer, &QLocalServer::newConnection, this, &FlatBufferServer::newLocalConnection);
+	// grabbers of other users connect through TCP, the shared memory is only accessible by its user anyway
+	_localServer->setSocketOptions(QLocalServer::UserAccessOption);
 
 	// apply config
 	handleSettingsUpdate(settings::FLATBUFSERVER, _config);
@@ -72,15 +83,7 @@ void FlatBufferServer::newConnection()
 			if(_netOrigin->accessAllowed(socket->peerAddress(), socket->localAddress()))
 			{
 				Debug(_log, "New connection from %s", QSTRING_CSTR(socket->peerAddress().toString()));
-				FlatBufferClient *client = new FlatBufferClient(socket, _timeout, this);
-				// internal
-				connect(client, &FlatBufferClient::clientDisconnected, this, &FlatBufferServer::clientDisconnected);
-				connect(client, &FlatBufferClient::registerGlobalInput, GlobalSignals::getInstance(), &GlobalSignals::registerGlobalInput);
-				connect(client, &FlatBufferClient::clearGlobalInput, GlobalSignals::getInstance(), &GlobalSignals::clearGlobalInput);
-				connect(client, &FlatBufferClient::setGlobalInputImage, GlobalSignals::getInstance(), &GlobalSignals::setGlobalImage);
-				connect(client, &FlatBufferClient::setGlobalInputColor, GlobalSignals::getInstance(), &GlobalSignals::setGlobalColor);
-				connect(GlobalSignals::getInstance(), &GlobalSignals::globalRegRequired, client, &FlatBufferClient::registationRequired);
-				_openConnections.append(client);
+				addClient(new FlatBufferClient(socket, _timeout, this));
 			}
 			else
 				socket->close();
@@ -88,6 +91,30 @@ void FlatBufferServer::newConnection()
 	}
 }
 
+void FlatBufferServer::newLocalConnection()
+{
+	while(_localServer->hasPendingConnections())
+	{
+		if(QLocalSocket* socket = _localServer->nextPendingConnection())
+		{
+			Debug(_log, "New local connection");
+			addClient(new FlatBufferClient(socket, _timeout, this));
+		}
+	}
+}
+
+void FlatBufferServer::addClient(FlatBufferClient* client)
+{
+	// internal
+	connect(client, &FlatBufferClient::clientDisconnected, this, &FlatBufferServer::clientDisconnected);
+	connect(client, &FlatBufferClient::registerGlobalInput, GlobalSignals::getInstance(), &GlobalSignals::registerGlobalInput);
+	connect(client, &FlatBufferClient::clearGlobalInput, GlobalSignals::getInstance(), &GlobalSignals::clearGlobalInput);
+	connect(client, &FlatBufferClient::setGlobalInputImage, GlobalSignals::getInstance(), &GlobalSignals::setGlobalImage);
+	connect(client, &FlatBufferClient::setGlobalInputColor, GlobalSignals::getInstance(), &GlobalSignals::setGlobalColor);
+	connect(GlobalSignals::getInstance(), &GlobalSignals::globalRegRequired, client, &FlatBufferClient::registationRequired);
+	_openConnections.append(client);
+}
+
 void FlatBufferServer::clientDisconnected()
 {
 	FlatBufferClient* client = qobject_cast<FlatBufferClient*>(sender());
@@ -121,6 +148,16 @@ void FlatBufferServer::startServer()
 #endif
 		}
 	}
+
+	if(!_localServer->isListening())
+	{
+		// remove the socket of a crashed instance
+		QLocalServer::removeServer(localServerName(_port));
+		if(!_localServer->listen(localServerName(_port)))
+		{
+			Warning(_log,"Failed to listen on the local socket %s", QSTRING_CSTR(localServerName(_port)));
+		}
+	}
 }
 
 void FlatBufferServer::stopServer()
@@ -135,4 +172,5 @@ void FlatBufferServer::stopServer()
 		_server->close();
 		Info(_log, "Stopped");
 	}
+	_localServer->close();
 }
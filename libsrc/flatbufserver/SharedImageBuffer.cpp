@@ -0,0 +1,232 @@
+#include "SharedImageBuffer.h"
+
+// stl
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const uint32_t HEADER_MAGIC = 0x48595053; // "HYPS"
+	const uint32_t SLOT_COUNT = 3;
+	const uint32_t SLOT_MASK = 0x3;
+	// set in the exchanged slot index while it holds an image the reader did not take yet
+	const uint32_t SLOT_DIRTY = 0x4;
+	// slots start at cache line boundaries
+	const size_t SLOT_ALIGNMENT = 64;
+}
+
+struct SharedImageHeader
+{
+	uint32_t magic;
+	uint32_t slotCapacity;
+	/// slot exchanged between writer and reader, combined with SLOT_DIRTY
+	std::atomic<uint32_t> exchangeSlot;
+	/// slots owned by the writer and the reader, kept here to survive reconnects of the reader
+	uint32_t writerSlot;
+	uint32_t readerSlot;
+	struct
+	{
+		uint32_t width;
+		uint32_t height;
+	} slots[SLOT_COUNT];
+};
+
+namespace {
+	size_t slotOffset(uint32_t slot, size_t slotCapacity)
+	{
+		const size_t headerSize = (sizeof(SharedImageHeader) + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+		const size_t slotSize = (slotCapacity + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+		return headerSize + slot * slotSize;
+	}
+}
+
+SharedImageBuffer::SharedImageBuffer(const QString& key)
+	: _key(key.startsWith('/') ? key : "/" + key)
+	, _header(nullptr)
+	, _mappedSize(0)
+	, _capacity(0)
+	, _owner(false)
+	, _fd(-1)
+{
+}
+
+SharedImageBuffer::~SharedImageBuffer()
+{
+	release();
+}
+
+void SharedImageBuffer::release()
+{
+#ifndef _WIN32
+	if (_header != nullptr)
+	{
+		munmap(_header, _mappedSize);
+		if (_owner)
+		{
+			shm_unlink(_key.toLocal8Bit().constData());
+		}
+	}
+	if (_fd >= 0)
+	{
+		close(_fd);
+	}
+#endif
+	_fd = -1;
+	_header = nullptr;
+	_mappedSize = 0;
+	_capacity = 0;
+	_owner = false;
+}
+
+bool SharedImageBuffer::create(size_t capacity)
+{
+	release();
+#ifndef _WIN32
+	const QByteArray name = _key.toLocal8Bit();
+	// only readable by the same user, like the local socket of the server
+	int fd = shm_open(name.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	const size_t size = slotOffset(SLOT_COUNT, capacity);
+	void* memory = MAP_FAILED;
+	if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+	{
+		memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+
+	if (memory == MAP_FAILED)
+	{
+		shm_unlink(name.constData());
+		return false;
+	}
+
+	_header = new (memory) SharedImageHeader;
+	_header->slotCapacity = static_cast<uint32_t>(capacity);
+	_header->writerSlot = 0;
+	_header->exchangeSlot.store(1, std::memory_order_relaxed);
+	_header->readerSlot = 2;
+	memset(_header->slots, 0, sizeof(_header->slots));
+	// publish the initialized header last
+	std::atomic_thread_fence(std::memory_order_release);
+	_header->magic = HEADER_MAGIC;
+
+	_mappedSize = size;
+	_capacity = capacity;
+	_owner = true;
+	return true;
+#else
+	Q_UNUSED(capacity);
+	return false;
+#endif
+}
+
+bool SharedImageBuffer::attach()
+{
+	release();
+#ifndef _WIN32
+	int fd = shm_open(_key.toLocal8Bit().constData(), O_RDWR, 0);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	void* memory = MAP_FAILED;
+	if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(SharedImageHeader))
+	{
+		memory = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+
+	if (memory == MAP_FAILED)
+	{
+		close(fd);
+		return false;
+	}
+	// kept open to verify the size before each access
+	_fd = fd;
+
+	_header = static_cast<SharedImageHeader*>(memory);
+	_mappedSize = static_cast<size_t>(info.st_size);
+
+	// the size is controlled by another process, verify it once
+	if (_header->magic != HEADER_MAGIC || slotOffset(SLOT_COUNT, _header->slotCapacity) > _mappedSize || _header->readerSlot >= SLOT_COUNT)
+	{
+		release();
+		return false;
+	}
+	_capacity = _header->slotCapacity;
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool SharedImageBuffer::isSizeIntact() const
+{
+#ifndef _WIN32
+	// the writer owns the object, accessing pages it truncated raises SIGBUS
+	struct stat info;
+	return _fd < 0 || (fstat(_fd, &info) == 0 && static_cast<size_t>(info.st_size) >= _mappedSize);
+#else
+	return true;
+#endif
+}
+
+uint8_t* SharedImageBuffer::slotData(uint32_t slot) const
+{
+	return reinterpret_cast<uint8_t*>(_header) + slotOffset(slot, _capacity);
+}
+
+bool SharedImageBuffer::write(const Image<ColorRgb>& image)
+{
+	if (_header == nullptr || image.size() > _capacity)
+	{
+		return false;
+	}
+
+	const uint32_t slot = _header->writerSlot;
+	memcpy(slotData(slot), image.memptr(), image.size());
+	_header->slots[slot].width = image.width();
+	_header->slots[slot].height = image.height();
+
+	// hand the slot over and continue with the one the reader did not take (or gave back)
+	_header->writerSlot = _header->exchangeSlot.exchange(slot | SLOT_DIRTY, std::memory_order_acq_rel) & SLOT_MASK;
+	return true;
+}
+
+bool SharedImageBuffer::takeLatest(int& width, int& height, const uint8_t*& data)
+{
+	if (_header == nullptr || !isSizeIntact() || (_header->exchangeSlot.load(std::memory_order_acquire) & SLOT_DIRTY) == 0)
+	{
+		return false;
+	}
+
+	const uint32_t slot = _header->exchangeSlot.exchange(_header->readerSlot, std::memory_order_acq_rel) & SLOT_MASK;
+	_header->readerSlot = slot;
+
+	// written by another process, never trust the slot and size
+	if (slot >= SLOT_COUNT)
+	{
+		return false;
+	}
+	width = static_cast<int>(_header->slots[slot].width);
+	height = static_cast<int>(_header->slots[slot].height);
+	if (width <= 0 || height <= 0 || size_t(width) * size_t(height) * 3 > _capacity)
+	{
+		return false;
+	}
+
+	data = slotData(slot);
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// util
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+// qt
+#include <QString>
+
+struct SharedImageHeader;
+
+///
+/// @brief Triple buffered RGB image in POSIX shared memory, written by a standalone grabber and read by the
+/// flatbuffer server on the same host. Writer and reader own one slot each, the third slot is exchanged lock free
+/// through the header, so neither side waits for the other. The object is only accessible by the user of the writer.
+/// Not available on Windows (isValid() is always false).
+///
+class SharedImageBuffer
+{
+public:
+	///
+	/// @param key  The name of the shared memory object
+	///
+	explicit SharedImageBuffer(const QString& key);
+	~SharedImageBuffer();
+
+	///
+	/// @brief Create the shared memory object (writer), it is removed again by the destructor
+	/// @param capacity  Maximum image size in bytes
+	/// @return True on success
+	///
+	bool create(size_t capacity);
+
+	///
+	/// @brief Attach to a shared memory object created by a writer (reader)
+	/// @return True on success
+	///
+	bool attach();
+
+	///
+	/// @return True if created or attached
+	///
+	bool isValid() const { return _header != nullptr; }
+
+	///
+	/// @return The name of the shared memory object
+	///
+	const QString& key() const { return _key; }
+
+	///
+	/// @return The maximum image size in bytes
+	///
+	size_t capacity() const { return _capacity; }
+
+	///
+	/// @brief Copy the image into the own slot and publish it (writer)
+	/// @param image The image
+	/// @return False if the image does not fit
+	///
+	bool write(const Image<ColorRgb>& image);
+
+	///
+	/// @brief Take the latest published image (reader), the data stays valid until the next call
+	/// @param[out] width   Width of the image
+	/// @param[out] height  Height of the image
+	/// @param[out] data    RGB data of the image
+	/// @return False if no new image was published since the last call
+	///
+	bool takeLatest(int& width, int& height, const uint8_t*& data);
+
+private:
+	void release();
+
+	uint8_t* slotData(uint32_t slot) const;
+
+	///
+	/// @return False if the writer shrank the object below the mapped size (reader)
+	///
+	bool isSizeIntact() const;
+
+	const QString _key;
+	SharedImageHeader* _header;
+	size_t _mappedSize;
+	/// slot size verified when attached, the header may be modified by the other process
+	size_t _capacity;
+	bool _owner;
+	/// descriptor of the attached object, -1 for the writer
+	int _fd;
+};
@@ -1,7 +1,16 @@
 #include "grabber/EncoderThread.h"
 
+#include <utils/Profiler.h>
+
 EncoderThread::EncoderThread()
-	: _localData(nullptr)
+	: _frameIndex(0)
+	, _bufferIndex(-1)
+	, _captureTime(0)
+	, _frameData(nullptr)
+	, _localData(nullptr)
+	, _flipBuffer(nullptr)
+	, _localDataSize(0)
+	, _flipBufferSize(0)
 	, _scalingFactorsCount(0)
 	, _imageResampler()
 #ifdef HAVE_TURBO_JPEG
@@ -20,22 +29,27 @@ EncoderThread::~EncoderThread()
 
 	if (_decompress)
 		tjDestroy(_decompress);
-#endif
 
-	if (_localData)
-#ifdef HAVE_TURBO_JPEG
-		tjFree(_localData);
-#else
-		delete[] _localData;
+	if (_flipBuffer)
+		tjFree(_flipBuffer);
+
+	delete _xform;
 #endif
+
+	delete[] _localData;
 }
 
 void EncoderThread::setup(
+	quint64 frameIndex, int bufferIndex,
 	PixelFormat pixelFormat, uint8_t* sharedData,
 	int size, int width, int height, int lineLength,
 	unsigned cropLeft, unsigned cropTop, unsigned cropBottom, unsigned cropRight,
 	VideoMode videoMode, FlipMode flipMode, int pixelDecimation)
 {
+	_busy = true;
+	_frameIndex = frameIndex;
+	_bufferIndex = bufferIndex;
+	_captureTime = LatencyTracer::now();
 	_lineLength = lineLength;
 	_pixelFormat = pixelFormat;
 	_size = (unsigned long) size;
@@ -54,23 +68,29 @@ void EncoderThread::setup(
 	_imageResampler.setHorizontalPixelDecimation(_pixelDecimation);
 	_imageResampler.setVerticalPixelDecimation(_pixelDecimation);
 
-#ifdef HAVE_TURBO_JPEG
-	if (_localData)
-		tjFree(_localData);
-
-	_localData = (uint8_t*)tjAlloc(size + 1);
-#else
-	delete[] _localData;
-	_localData = nullptr;
-	_localData = new uint8_t(size + 1);
-#endif
+	if (bufferIndex >= 0)
+	{
+		// the capture buffer stays dequeued until frameProcessed(), decode it in place
+		_frameData = sharedData;
+	}
+	else
+	{
+		// the source is reused by the grabber, keep a copy in a buffer that only grows
+		if (_localDataSize < _size)
+		{
+			delete[] _localData;
+			_localData = new uint8_t[_size + 1];
+			_localDataSize = _size;
+		}
 
-	memcpy(_localData, sharedData, size);
+		memcpy(_localData, sharedData, _size);
+		_frameData = _localData;
+	}
 }
 
 void EncoderThread::process()
 {
-	_busy = true;
+	PROFILER_SCOPE("EncoderThread::process")
 	if (_width > 0 && _height > 0)
 	{
 #ifdef HAVE_TURBO_JPEG
@@ -95,7 +115,7 @@ void EncoderThread::process()
 
 			Image<ColorRgb> image = Image<ColorRgb>();
 			_imageResampler.processImage(
-				_localData,
+				_frameData,
 				_width,
 				_height,
 				_lineLength,
@@ -107,33 +127,30 @@ void EncoderThread::process()
 				image
 			);
 
-			emit newFrame(image);
+			image.setCaptureTime(_captureTime);
+			emit newFrame(image, _frameIndex);
 		}
 	}
+
+	emit frameProcessed(_frameIndex, _bufferIndex);
+
+	QMutexLocker lock(&_idleMutex);
 	_busy = false;
+	_idle.wakeAll();
 }
 
-#ifdef HAVE_TURBO_JPEG
-void EncoderThread::processImageMjpeg()
+void EncoderThread::waitUntilIdle()
 {
-	if (!_transform && _flipMode != FlipMode::NO_CHANGE)
+	QMutexLocker lock(&_idleMutex);
+	while (_busy)
 	{
-		_transform = tjInitTransform();
-		_xform = new tjtransform();
-	}
-
-	if (_flipMode == FlipMode::BOTH || _flipMode == FlipMode::HORIZONTAL)
-	{
-		_xform->op = TJXOP_HFLIP;
-		tjTransform(_transform, _localData, _size, 1, &_localData, &_size, _xform, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
-	}
-
-	if (_flipMode == FlipMode::BOTH || _flipMode == FlipMode::VERTICAL)
-	{
-		_xform->op = TJXOP_VFLIP;
-		tjTransform(_transform, _localData, _size, 1, &_localData, &_size, _xform, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
+		_idle.wait(&_idleMutex);
 	}
+}
 
+#ifdef HAVE_TURBO_JPEG
+void EncoderThread::processImageMjpeg()
+{
 	if (!_decompress)
 	{
 		_decompress = tjInitDecompress();
@@ -141,9 +158,43 @@ void EncoderThread::processImageMjpeg()
 	}
 
 	int subsamp = 0;
-	if (tjDecompressHeader2(_decompress, _localData, _size, &_width, &_height, &subsamp) != 0)
+	if (tjDecompressHeader2(_decompress, _frameData, _size, &_width, &_height, &subsamp) != 0)
 		return;
 
+	if (_flipMode != FlipMode::NO_CHANGE)
+	{
+		if (!_transform)
+		{
+			_transform = tjInitTransform();
+			_xform = new tjtransform();
+		}
+
+		if (_flipMode == FlipMode::BOTH)
+			_xform->op = TJXOP_ROT180;
+		else if (_flipMode == FlipMode::HORIZONTAL)
+			_xform->op = TJXOP_HFLIP;
+		else
+			_xform->op = TJXOP_VFLIP;
+
+		// transform into a reusable worst case sized buffer, the frame data itself may be a capture buffer
+		const unsigned long flipBufferSize = tjBufSize(_width, _height, subsamp);
+		if (_flipBufferSize < flipBufferSize)
+		{
+			if (_flipBuffer)
+				tjFree(_flipBuffer);
+
+			_flipBuffer = tjAlloc(flipBufferSize);
+			_flipBufferSize = flipBufferSize;
+		}
+
+		unsigned long flipSize = _flipBufferSize;
+		if (_flipBuffer == nullptr || tjTransform(_transform, _frameData, _size, 1, &_flipBuffer, &flipSize, _xform, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE | TJFLAG_NOREALLOC) != 0)
+			return;
+
+		_frameData = _flipBuffer;
+		_size = flipSize;
+	}
+
 	int scaledWidth = _width, scaledHeight = _height;
 	if(_scalingFactors != nullptr && _pixelDecimation > 1)
 	{
@@ -168,12 +219,15 @@ void EncoderThread::processImageMjpeg()
 
 	Image<ColorRgb> srcImage(scaledWidth, scaledHeight);
 
-	if (tjDecompress2(_decompress, _localData , _size, (unsigned char*)srcImage.memptr(), scaledWidth, 0, scaledHeight, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
+	if (tjDecompress2(_decompress, _frameData, _size, (unsigned char*)srcImage.memptr(), scaledWidth, 0, scaledHeight, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
 			return;
 
 	// got image, process it
 	if (!(_cropLeft > 0 || _cropTop > 0 || _cropBottom > 0 || _cropRight > 0))
-		emit newFrame(srcImage);
+	{
+		srcImage.setCaptureTime(_captureTime);
+		emit newFrame(srcImage, _frameIndex);
+	}
 	else
     {
 		// calculate the output size
@@ -190,14 +244,11 @@ void EncoderThread::processImageMjpeg()
 			unsigned char* source = (unsigned char*)srcImage.memptr() + (y + _cropTop)*srcImage.width()*3 + _cropLeft*3;
 			unsigned char* dest = (unsigned char*)destImage.memptr() + y*destImage.width()*3;
 			memcpy(dest, source, destImage.width()*3);
-			free(source);
-			source = nullptr;
-			free(dest);
-			dest = nullptr;
 		}
 
     	// emit
-		emit newFrame(destImage);
+		destImage.setCaptureTime(_captureTime);
+		emit newFrame(destImage, _frameIndex);
 	}
 }
 #endif
@@ -207,6 +207,7 @@ bool V4L2Grabber::start()
 		if (init() && _streamNotifier != nullptr && !_streamNotifier->isEnabled())
 		{
 			connect(_threadManager, &EncoderThreadManager::newFrame, this, &V4L2Grabber::newThreadFrame);
+			connect(_threadManager, &EncoderThreadManager::releaseBuffer, this, &V4L2Grabber::releaseBuffer);
 			_threadManager->start();
 			DebugIf(verbose, _log, "Decoding threads: %d", _threadManager->_threadCount);
 
@@ -231,6 +232,7 @@ void V4L2Grabber::stop()
 		_initialized = false;
 		_threadManager->stop();
 		disconnect(_threadManager, nullptr, nullptr, nullptr);
+		Debug(_log, "Decoded frames: %llu, dropped frames: %llu", _threadManager->processedFrames(), _threadManager->droppedFrames());
 		stop_capturing();
 		_streamNotifier->setEnabled(false);
 		uninit_device();
@@ -905,7 +907,7 @@ int V4L2Grabber::read_frame()
 					}
 				}
 
-				rc = process_image(_buffers[0].start, size);
+				rc = process_image(-1, _buffers[0].start, size);
 			}
 			break;
 
@@ -936,9 +938,10 @@ int V4L2Grabber::read_frame()
 
 				assert(buf.index < _buffers.size());
 
-				rc = process_image(_buffers[buf.index].start, buf.bytesused);
+				// the buffer stays dequeued until the encoder thread releases it
+				rc = process_image(buf.index, _buffers[buf.index].start, buf.bytesused);
 
-				if (-1 == xioctl(VIDIOC_QBUF, &buf))
+				if (!rc && -1 == xioctl(VIDIOC_QBUF, &buf))
 				{
 					throw_errno_exception("VIDIOC_QBUF");
 					return 0;
@@ -971,15 +974,18 @@ int V4L2Grabber::read_frame()
 					}
 				}
 
+				int bufferIndex = -1;
 				for (size_t i = 0; i < _buffers.size(); ++i)
 				{
 					if (buf.m.userptr == (unsigned long)_buffers[i].start && buf.length == _buffers[i].length)
 					{
+						bufferIndex = i;
 						break;
 					}
 				}
 
-				rc = process_image((void *)buf.m.userptr, buf.bytesused);
+				// the buffer stays dequeued until the encoder thread releases it
+				rc = process_image(bufferIndex, (void *)buf.m.userptr, buf.bytesused);
 
 				if (!rc && -1 == xioctl(VIDIOC_QBUF, &buf))
 				{
@@ -999,7 +1005,39 @@ int V4L2Grabber::read_frame()
 	return rc ? 1 : 0;
 }
 
-bool V4L2Grabber::process_image(const void *p, int size)
+void V4L2Grabber::releaseBuffer(int bufferIndex)
+{
+	if (!_initialized || bufferIndex < 0 || bufferIndex >= (int)_buffers.size())
+		return;
+
+	struct v4l2_buffer buf;
+	CLEAR(buf);
+
+	buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	buf.index = bufferIndex;
+
+	switch (_ioMethod)
+	{
+		case IO_METHOD_MMAP:
+			buf.memory = V4L2_MEMORY_MMAP;
+		break;
+
+		case IO_METHOD_USERPTR:
+			buf.memory = V4L2_MEMORY_USERPTR;
+			buf.m.userptr = (unsigned long)_buffers[bufferIndex].start;
+			buf.length = _buffers[bufferIndex].length;
+		break;
+
+		case IO_METHOD_READ:
+		default:
+			return;
+	}
+
+	if (-1 == xioctl(VIDIOC_QBUF, &buf))
+		throw_errno_exception("VIDIOC_QBUF");
+}
+
+bool V4L2Grabber::process_image(int bufferIndex, const void *p, int size)
 {
 	int processFrameIndex = _currentFrame++, result = false;
 
@@ -1017,16 +1055,7 @@ bool V4L2Grabber::process_image(const void *p, int size)
 	}
 	else if (_threadManager != nullptr)
 	{
-		for (int i = 0; i < _threadManager->_threadCount; i++)
-		{
-			if (!_threadManager->_threads[i]->isBusy())
-			{
-				_threadManager->_threads[i]->setup(_pixelFormat, (uint8_t*)p, size, _width, _height, _lineLength, _cropLeft, _cropTop, _cropBottom, _cropRight, _videoMode, _flipMode, _pixelDecimation);
-				_threadManager->_threads[i]->process();
-				result = true;
-				break;
-			}
-		}
+		result = _threadManager->process(bufferIndex, _pixelFormat, (uint8_t*)p, size, _width, _height, _lineLength, _cropLeft, _cropTop, _cropBottom, _cropRight, _videoMode, _flipMode, _pixelDecimation);
 	}
 
 	return result;
@@ -9,9 +9,20 @@
 // qt
 #include <QTimer>
 
+// stl
+#include <cstring>
+
 GrabberWrapper* GrabberWrapper::instance = nullptr;
 const int GrabberWrapper::DEFAULT_RATE_HZ = 10;
 
+namespace {
+	/// unchanged images are forwarded after this time (us) anyway, below the inactive timeouts of the capture inputs
+	const qint64 UNCHANGED_FRAME_KEEPALIVE_US = 500 * 1000;
+
+	const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	const uint64_t FNV_PRIME = 1099511628211ULL;
+}
+
 GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, unsigned width, unsigned height, unsigned updateRate_Hz)
 	: _grabberName(grabberName)
 	, _timer(new QTimer(this))
@@ -19,6 +30,8 @@ GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, u
 	, _log(Logger::getInstance(grabberName.toUpper()))
 	, _ggrabber(ggrabber)
 	, _image(0,0)
+	, _forwardedImageHash(0)
+	, _forwardedImageTime(0)
 {
 	GrabberWrapper::instance = this;
 
@@ -44,6 +57,35 @@ GrabberWrapper::~GrabberWrapper()
 	Debug(_log,"Close grabber: %s", QSTRING_CSTR(_grabberName));
 }
 
+bool GrabberWrapper::isUnchangedFrame(const Image<ColorRgb>& image)
+{
+	// FNV-1a over 8 byte words: every step is a bijection of the state, so a single changed word always changes the hash
+	uint64_t hash = FNV_OFFSET_BASIS ^ ((uint64_t(image.width()) << 32) | image.height());
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(image.memptr());
+	const size_t size = static_cast<size_t>(image.size());
+
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		hash = (hash ^ word) * FNV_PRIME;
+	}
+	for (; i < size; ++i)
+	{
+		hash = (hash ^ data[i]) * FNV_PRIME;
+	}
+
+	if (hash == _forwardedImageHash && image.captureTime() - _forwardedImageTime < UNCHANGED_FRAME_KEEPALIVE_US)
+	{
+		return true;
+	}
+
+	_forwardedImageHash = hash;
+	_forwardedImageTime = image.captureTime();
+	return false;
+}
+
 bool GrabberWrapper::start()
 {
 	bool rc = false;
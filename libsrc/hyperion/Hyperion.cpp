@@ -17,6 +17,8 @@
 #include <utils/hyperion.h>
 #include <utils/GlobalSignals.h>
 #include <utils/Logger.h>
+#include <utils/LatencyTracer.h>
+#include <utils/Profiler.h>
 
 // LedDevice includes
 #include <leddevice/LedDeviceWrapper.h>
@@ -90,6 +92,7 @@ void Hyperion::start()
 	{
 		_ledStringColorOrder.push_back(led.colorOrder);
 	}
+	updateLedOutputLayout();
 
 	// connect Hyperion::update with Muxer visible priority changes as muxer updates independent
 	connect(&_muxer, &PriorityMuxer::visiblePriorityChanged, this, &Hyperion::update);
@@ -113,7 +116,8 @@ void Hyperion::start()
 
 	_ledDeviceWrapper = new LedDeviceWrapper(this);
 	connect(this, &Hyperion::compStateChangeRequest, _ledDeviceWrapper, &LedDeviceWrapper::handleComponentState);
-	connect(this, &Hyperion::ledDeviceData, _ledDeviceWrapper, &LedDeviceWrapper::updateLeds);
+	// the wrapper's mailbox is thread safe, the smoothing emits from its output thread
+	connect(this, &Hyperion::ledDeviceData, _ledDeviceWrapper, &LedDeviceWrapper::updateLeds, Qt::DirectConnection);
 	_ledDeviceWrapper->createLedDevice(ledDevice);
 
 	// smoothing
@@ -174,6 +178,9 @@ void Hyperion::freeObjects()
 	delete _raw2ledAdjustment;
 	delete _messageForwarder;
 	delete _settingsManager;
+	// stops the smoothing output thread before its receiver is gone
+	delete _deviceSmooth;
+	_deviceSmooth = nullptr;
 	delete _ledDeviceWrapper;
 }
 
@@ -188,6 +195,7 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 		// change in color recreate ledAdjustments
 		delete _raw2ledAdjustment;
 		_raw2ledAdjustment = hyperion::createLedColorsAdjustment(static_cast<int>(_ledString.leds().size()), obj);
+		updateLedOutputLayout();
 
 		if (!_raw2ledAdjustment->verifyAdjustments())
 		{
@@ -222,6 +230,7 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 		// change in leds are also reflected in adjustment
 		delete _raw2ledAdjustment;
 		_raw2ledAdjustment = hyperion::createLedColorsAdjustment(static_cast<int>(_ledString.leds().size()), getSetting(settings::COLOR).object());
+		updateLedOutputLayout();
 
 		// start cached effects
 		_effectEngine->startCachedEffects();
@@ -245,6 +254,7 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 				_ledStringColorOrder.push_back(led.colorOrder);
 			}
 		}
+		updateLedOutputLayout();
 
 		// do always reinit until the led devices can handle dynamic changes
 		dev["currentLedCount"] = _hwLedCount; // Inject led count info
@@ -276,6 +286,16 @@ int Hyperion::getLatchTime() const
 	return _ledDeviceWrapper->getLatchTime();
 }
 
+QJsonObject Hyperion::getLedDeviceStatistics() const
+{
+	return _ledDeviceWrapper->getMailboxStatistics();
+}
+
+QJsonArray Hyperion::getForwarderStatistics() const
+{
+	return (_messageForwarder != nullptr) ? _messageForwarder->getJsonSlaveStatistics() : QJsonArray();
+}
+
 unsigned Hyperion::addSmoothingConfig(int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay)
 {
 	return _deviceSmooth->addConfig(settlingTime_ms, ledUpdateFrequency_hz, updateDelay);
@@ -427,6 +447,7 @@ ColorAdjustment * Hyperion::getAdjustment(const QString& id) const
 
 void Hyperion::adjustmentsUpdated()
 {
+	_raw2ledAdjustment->updateAdjustments();
 	emit adjustmentChanged();
 	update();
 }
@@ -572,18 +593,31 @@ void Hyperion::handlePriorityChangedLedDevice(const quint8& priority)
 	}
 }
 
+void Hyperion::updateLedOutputLayout()
+{
+	_raw2ledAdjustment->setOutputLayout(_ledStringColorOrder, _hwLedCount);
+}
+
 void Hyperion::update()
 {
-	// Obtain the current priority channel
+	PROFILER_SCOPE("Hyperion::update")
+	const qint64 traceStart = LatencyTracer::now();
+
+	// Obtain the current priority channel, without copying it
 	int priority = _muxer.getCurrentPriority();
-	const PriorityMuxer::InputInfo priorityInfo = _muxer.getInputInfo(priority);
+	const PriorityMuxer::InputInfo& priorityInfo = _muxer.getInputInfo(priority);
+	const unsigned smoothCfg = priorityInfo.smooth_cfg;
 
-	// copy image & process OR copy ledColors from muxer
-	Image<ColorRgb> image = priorityInfo.image;
+	// process image OR copy ledColors from muxer, both into the reused led buffer
+	// the image handle is copied (shared, not the pixels), slots of currentImage may change the muxer inputs
+	const Image<ColorRgb> image = priorityInfo.image;
+	const qint64 captureTime = image.captureTime();
 	if (image.width() > 1 || image.height() > 1)
 	{
 		emit currentImage(image);
-		_ledBuffer = _imageProcessor->process(image);
+		const qint64 processStart = LatencyTracer::now();
+		_imageProcessor->process(image, _ledBuffer);
+		LatencyTracer::recordSince(LatencyTracer::IMAGE_PROCESS, processStart);
 	}
 	else
 	{
@@ -593,62 +627,29 @@ void Hyperion::update()
 	// emit rawLedColors before transform
 	emit rawLedColors(_ledBuffer);
 
-	_raw2ledAdjustment->applyAdjustment(_ledBuffer);
-
-	int i = 0;
-	for (ColorRgb& color : _ledBuffer)
-	{
-		// correct the color byte order
-		switch (_ledStringColorOrder.at(i))
-		{
-		case ColorOrder::ORDER_RGB:
-			// leave as it is
-			break;
-		case ColorOrder::ORDER_BGR:
-			std::swap(color.red, color.blue);
-			break;
-		case ColorOrder::ORDER_RBG:
-			std::swap(color.green, color.blue);
-			break;
-		case ColorOrder::ORDER_GRB:
-			std::swap(color.red, color.green);
-			break;
-		case ColorOrder::ORDER_GBR:
-			std::swap(color.red, color.green);
-			std::swap(color.green, color.blue);
-			break;
-
-		case ColorOrder::ORDER_BRG:
-			std::swap(color.red, color.blue);
-			std::swap(color.green, color.blue);
-			break;
-		}
-		i++;
-	}
-
-	// fill additional hardware LEDs with black
-	if ( _hwLedCount > static_cast<int>(_ledBuffer.size()) )
-	{
-		_ledBuffer.resize(_hwLedCount, ColorRgb::BLACK);
-	}
+	// adjust, reorder and pad in one pass into the reused output buffer
+	_raw2ledAdjustment->applyAdjustment(_ledBuffer, _ledOutputBuffer);
 
 	// Write the data to the device
 	if (_ledDeviceWrapper->enabled())
 	{
+		// frames written from now on originate from this capture (0 for color/effect inputs)
+		_ledDeviceWrapper->setCaptureTime(captureTime);
+
 		// Smoothing is disabled
 		if  (! _deviceSmooth->enabled())
 		{
-			//std::cout << "Hyperion::update()> Non-Smoothing - "; LedDevice::printLedValues ( _ledBuffer);
-			emit ledDeviceData(_ledBuffer);
+			//std::cout << "Hyperion::update()> Non-Smoothing - "; LedDevice::printLedValues ( _ledOutputBuffer);
+			emit ledDeviceData(_ledOutputBuffer);
 		}
 		else
 		{
-			_deviceSmooth->selectConfig(priorityInfo.smooth_cfg);
+			_deviceSmooth->selectConfig(smoothCfg);
 
 			// feed smoothing in pause mode to maintain a smooth transition back to smooth mode
 			if (_deviceSmooth->enabled() || _deviceSmooth->pause())
 			{
-				_deviceSmooth->updateLedValues(_ledBuffer);
+				_deviceSmooth->updateLedValues(_ledOutputBuffer);
 			}
 		}
 	}
@@ -659,4 +660,6 @@ void Hyperion::update()
 		Debug(_log, "LEDDevice is disabled - no update required");
 	}
 	#endif
+
+	LatencyTracer::recordSince(LatencyTracer::HYPERION_UPDATE, traceStart);
 }
@@ -9,6 +9,11 @@
 
 using namespace hyperion;
 
+namespace {
+	/// mappings kept per image processor, they share one summed-area table of the image size
+	const size_t MAX_CACHED_MAPPINGS = 4;
+}
+
 // global transform method
 int ImageProcessor::mappingTypeToInt(const QString& mappingType)
 {
@@ -32,6 +37,7 @@ ImageProcessor::ImageProcessor(const LedString& ledString, Hyperion* hyperion)
 	, _ledString(ledString)
 	, _borderProcessor(new BlackBorderProcessor(hyperion, this))
 	, _imageToLeds(nullptr)
+	, _integralImage(std::make_shared<std::vector<uint32_t>>())
 	, _mappingType(0)
 	, _userMappingType(0)
 	, _hardMappingType(0)
@@ -45,7 +51,6 @@ ImageProcessor::ImageProcessor(const LedString& ledString, Hyperion* hyperion)
 
 ImageProcessor::~ImageProcessor()
 {
-	delete _imageToLeds;
 }
 
 void ImageProcessor::handleSettingsUpdate(settings::type type, const QJsonDocument& config)
@@ -69,11 +74,14 @@ void ImageProcessor::setSize(unsigned width, unsigned height)
 		return;
 	}
 
-	// Clean up the old buffer and mapping
-	delete _imageToLeds;
-
-	// Construct a new buffer and mapping
-	_imageToLeds = (width>0 && height>0) ? (new ImageToLedsMap(width, height, 0, 0, _ledString.leds())) : nullptr;
+	if (width>0 && height>0)
+	{
+		useImageToLedsMap(width, height, 0, 0);
+	}
+	else
+	{
+		_imageToLeds = nullptr;
+	}
 }
 
 void ImageProcessor::setLedString(const LedString& ledString)
@@ -86,12 +94,35 @@ void ImageProcessor::setLedString(const LedString& ledString)
 		unsigned width = _imageToLeds->width();
 		unsigned height = _imageToLeds->height();
 
-		// Clean up the old buffer and mapping
-		delete _imageToLeds;
+		// The cached mappings belong to the old led string
+		_imageToLeds = nullptr;
+		_imageToLedsCache.clear();
 
 		// Construct a new buffer and mapping
-		_imageToLeds = new ImageToLedsMap(width, height, 0, 0, _ledString.leds());
+		useImageToLedsMap(width, height, 0, 0);
+	}
+}
+
+void ImageProcessor::useImageToLedsMap(unsigned width, unsigned height, unsigned horizontalBorder, unsigned verticalBorder)
+{
+	for (auto it = _imageToLedsCache.begin(); it != _imageToLedsCache.end(); ++it)
+	{
+		const ImageToLedsMap& map = **it;
+		if (map.width() == width && map.height() == height && map.horizontalBorder() == horizontalBorder && map.verticalBorder() == verticalBorder)
+		{
+			_imageToLedsCache.splice(_imageToLedsCache.begin(), _imageToLedsCache, it);
+			_imageToLeds = _imageToLedsCache.front().get();
+			return;
+		}
+	}
+
+	// Construct a new mapping and drop the least recently used one
+	_imageToLedsCache.emplace_front(new ImageToLedsMap(width, height, horizontalBorder, verticalBorder, _ledString.leds(), _integralImage));
+	if (_imageToLedsCache.size() > MAX_CACHED_MAPPINGS)
+	{
+		_imageToLedsCache.pop_back();
 	}
+	_imageToLeds = _imageToLedsCache.front().get();
 }
 
 void ImageProcessor::setBlackbarDetectDisable(bool enable)
@@ -7,12 +7,15 @@ ImageToLedsMap::ImageToLedsMap(
 		unsigned height,
 		unsigned horizontalBorder,
 		unsigned verticalBorder,
-		const std::vector<Led>& leds)
+		const std::vector<Led>& leds,
+		std::shared_ptr<std::vector<uint32_t>> integralImage)
 	: _width(width)
 	, _height(height)
 	, _horizontalBorder(horizontalBorder)
 	, _verticalBorder(verticalBorder)
 	, _colorsMap()
+	, _useIntegralImage(false)
+	, _integralImage(integralImage ? integralImage : std::make_shared<std::vector<uint32_t>>())
 {
 	// Sanity check of the size of the borders (and width and height)
 	Q_ASSERT(_width  > 2*_verticalBorder);
@@ -28,12 +31,15 @@ ImageToLedsMap::ImageToLedsMap(
 	const unsigned yOffset      = _horizontalBorder;
 	const unsigned actualHeight = _height - 2 * _horizontalBorder;
 
+	// Total number of pixels covered by all leds, used to pick the evaluation strategy
+	size_t totalArea = 0;
+
 	for (const Led& led : leds)
 	{
 		// skip leds without area
 		if ((led.maxX_frac-led.minX_frac) < 1e-6 || (led.maxY_frac-led.minY_frac) < 1e-6)
 		{
-			_colorsMap.emplace_back();
+			_colorsMap.push_back({0, 0, 0, 0});
 			continue;
 		}
 
@@ -55,24 +61,25 @@ ImageToLedsMap::ImageToLedsMap(
 			maxY_idx++;
 		}
 
-		// Add all the indices in the above defined rectangle to the indices for this led
+		// Clip the rectangle to the visible area
 		const auto maxYLedCount = qMin(maxY_idx, yOffset+actualHeight);
 		const auto maxXLedCount = qMin(maxX_idx, xOffset+actualWidth);
 
-		std::vector<int32_t> ledColors;
-		ledColors.reserve((size_t) maxXLedCount*maxYLedCount);
-
-		for (unsigned y = minY_idx; y < maxYLedCount; ++y)
+		LedRegion region {minX_idx, maxXLedCount, minY_idx, maxYLedCount};
+		if (region.minX >= region.maxX || region.minY >= region.maxY)
 		{
-			for (unsigned x = minX_idx; x < maxXLedCount; ++x)
-			{
-				ledColors.push_back(y*width + x);
-			}
+			region = {0, 0, 0, 0};
 		}
 
-		// Add the constructed vector to the map
-		_colorsMap.push_back(ledColors);
+		totalArea += region.area();
+
+		// Add the constructed region to the map
+		_colorsMap.push_back(region);
 	}
+
+	// Scanning each region is cheaper as long as the leds cover less pixels than the image.
+	// Otherwise (overlapping or large regions) a single pass to build the summed-area table wins.
+	_useIntegralImage = totalArea > size_t(_width) * _height;
 }
 
 unsigned ImageToLedsMap::width() const
@@ -0,0 +1,190 @@
+#include "JsonForwardConnection.h"
+
+// utils includes
+#include <utils/Logger.h>
+
+// Qt includes
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QMutexLocker>
+
+namespace {
+	/// unsent messages kept per slave, the oldest one is dropped beyond
+	const size_t MAX_QUEUE_SIZE = 64;
+	/// data handed to the socket before further messages stay queued (and can still be coalesced)
+	const qint64 MAX_PENDING_BYTES = 64 * 1024;
+	const int MIN_RECONNECT_DELAY_MS = 500;
+	const int MAX_RECONNECT_DELAY_MS = 16000;
+}
+
+JsonForwardConnection::JsonForwardConnection(const QString& address, Logger* log, QObject* parent)
+	: QObject(parent)
+	, _log(log)
+	, _address(address)
+	, _port(0)
+	, _socket()
+	, _reconnectTimer()
+	, _reconnectDelay(MIN_RECONNECT_DELAY_MS)
+	, _state("connecting")
+	, _sent(0)
+	, _coalesced(0)
+	, _dropped(0)
+	, _replyErrors(0)
+	, _reconnects(0)
+{
+	const QStringList parts = address.split(":");
+	_host = parts.value(0);
+	_port = parts.value(1).toUShort();
+
+	_reconnectTimer.setSingleShot(true);
+	connect(&_reconnectTimer, &QTimer::timeout, this, &JsonForwardConnection::connectToSlave);
+
+	connect(&_socket, &QTcpSocket::connected, this, &JsonForwardConnection::handleConnected);
+	connect(&_socket, &QTcpSocket::readyRead, this, &JsonForwardConnection::handleReadyRead);
+	connect(&_socket, &QTcpSocket::bytesWritten, this, &JsonForwardConnection::writeQueue);
+	// covers lost connections as well as refused or timed out connection attempts
+	connect(&_socket, &QTcpSocket::stateChanged, this, [this](QAbstractSocket::SocketState state) {
+		if (state == QAbstractSocket::UnconnectedState && !_reconnectTimer.isActive())
+		{
+			handleDisconnected();
+		}
+	});
+
+	connectToSlave();
+}
+
+JsonForwardConnection::~JsonForwardConnection()
+{
+	_reconnectTimer.stop();
+	_socket.disconnect(this);
+	_socket.abort();
+}
+
+void JsonForwardConnection::send(const QString& key, const QByteArray& message)
+{
+	{
+		QMutexLocker lock(&_mutex);
+
+		// a newer state of the same priority supersedes the queued one, it is sent in the order of the newer message
+		if (!key.isEmpty())
+		{
+			for (auto it = _queue.begin(); it != _queue.end(); ++it)
+			{
+				if (it->first == key)
+				{
+					_queue.erase(it);
+					++_coalesced;
+					break;
+				}
+			}
+		}
+
+		if (_queue.size() >= MAX_QUEUE_SIZE)
+		{
+			_queue.pop_front();
+			++_dropped;
+		}
+		_queue.emplace_back(key, message);
+	}
+
+	writeQueue();
+}
+
+void JsonForwardConnection::connectToSlave()
+{
+	if (_socket.state() == QAbstractSocket::UnconnectedState)
+	{
+		_socket.connectToHost(QHostAddress(_host), _port);
+	}
+}
+
+void JsonForwardConnection::handleConnected()
+{
+	Debug(_log, "Connected to json target %s", QSTRING_CSTR(_address));
+	_reconnectDelay = MIN_RECONNECT_DELAY_MS;
+	_replyBuffer.clear();
+	{
+		QMutexLocker lock(&_mutex);
+		_state = "connected";
+	}
+	writeQueue();
+}
+
+void JsonForwardConnection::handleDisconnected()
+{
+	{
+		QMutexLocker lock(&_mutex);
+		if (_state == "connected")
+		{
+			Debug(_log, "Connection to json target %s lost", QSTRING_CSTR(_address));
+		}
+		_state = "disconnected";
+		++_reconnects;
+	}
+
+	// retry with increasing delay, queued messages are kept (and coalesced) meanwhile
+	_reconnectTimer.start(_reconnectDelay);
+	_reconnectDelay = qMin(2 * _reconnectDelay, MAX_RECONNECT_DELAY_MS);
+}
+
+void JsonForwardConnection::handleReadyRead()
+{
+	_replyBuffer += _socket.readAll();
+
+	int lineEnd;
+	while ((lineEnd = _replyBuffer.indexOf('\n')) >= 0)
+	{
+		const QByteArray line = _replyBuffer.left(lineEnd);
+		_replyBuffer.remove(0, lineEnd + 1);
+
+		QJsonParseError error;
+		const QJsonDocument reply = QJsonDocument::fromJson(line, &error);
+		if (error.error != QJsonParseError::NoError)
+		{
+			Error(_log, "Error while parsing reply of %s: invalid json", QSTRING_CSTR(_address));
+		}
+		else if (!reply.object()["success"].toBool(true))
+		{
+			Debug(_log, "Json target %s replied: %s", QSTRING_CSTR(_address), QSTRING_CSTR(reply.object()["error"].toString()));
+		}
+		else
+		{
+			continue;
+		}
+
+		QMutexLocker lock(&_mutex);
+		++_replyErrors;
+	}
+}
+
+void JsonForwardConnection::writeQueue()
+{
+	if (_socket.state() != QAbstractSocket::ConnectedState)
+	{
+		return;
+	}
+
+	QMutexLocker lock(&_mutex);
+	while (!_queue.empty() && _socket.bytesToWrite() < MAX_PENDING_BYTES)
+	{
+		_socket.write(_queue.front().second);
+		_queue.pop_front();
+		++_sent;
+	}
+}
+
+QJsonObject JsonForwardConnection::getStatistics() const
+{
+	QMutexLocker lock(&_mutex);
+
+	QJsonObject statistics;
+	statistics["address"] = _address;
+	statistics["state"] = _state;
+	statistics["queued"] = static_cast<int>(_queue.size());
+	statistics["sent"] = static_cast<double>(_sent);
+	statistics["coalesced"] = static_cast<double>(_coalesced);
+	statistics["dropped"] = static_cast<double>(_dropped);
+	statistics["replyErrors"] = static_cast<double>(_replyErrors);
+	statistics["reconnects"] = static_cast<double>(_reconnects);
+	return statistics;
+}
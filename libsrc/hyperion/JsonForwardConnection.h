@@ -0,0 +1,82 @@
+#pragma once
+
+// STL includes
+#include <deque>
+#include <utility>
+
+// Qt includes
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QMutex>
+#include <QJsonObject>
+
+class Logger;
+
+///
+/// @brief Long-lived connection to a JSON forwarder slave.
+/// Messages are queued while the slave is not connected or busy and sent pipelined without waiting for replies.
+/// A queued color/image command of a priority is replaced by a newer one of the same priority.
+/// The connection is reestablished automatically with increasing delay.
+///
+class JsonForwardConnection : public QObject
+{
+	Q_OBJECT
+
+public:
+	///
+	/// @param address  The slave address (host:port)
+	/// @param log      The logger of the forwarder
+	/// @param parent   The parent
+	///
+	JsonForwardConnection(const QString& address, Logger* log, QObject* parent = nullptr);
+	~JsonForwardConnection() override;
+
+	///
+	/// @brief Queue a serialized message and send it as soon as possible
+	/// @param key      Messages with the same non empty key supersede each other while queued
+	/// @param message  The serialized message including the line break
+	///
+	void send(const QString& key, const QByteArray& message);
+
+	///
+	/// @brief Get the state of the connection, can be called from any thread
+	/// @return Address, state, queue length and message counters
+	///
+	QJsonObject getStatistics() const;
+
+private slots:
+	void connectToSlave();
+	void handleConnected();
+	void handleDisconnected();
+	void handleReadyRead();
+
+	///
+	/// @brief Write queued messages while the socket buffer is below the limit
+	///
+	void writeQueue();
+
+private:
+	Logger* _log;
+	const QString _address;
+	QString _host;
+	quint16 _port;
+
+	QTcpSocket _socket;
+	QTimer _reconnectTimer;
+	int _reconnectDelay;
+
+	/// key and message of the unsent messages
+	std::deque<std::pair<QString, QByteArray>> _queue;
+	/// received reply data without line break yet
+	QByteArray _replyBuffer;
+
+	/// guards the queue and the statistics, read by getStatistics() from other threads
+	mutable QMutex _mutex;
+	QString _state;
+	quint64 _sent;
+	quint64 _coalesced;
+	quint64 _dropped;
+	quint64 _replyErrors;
+	quint64 _reconnects;
+};
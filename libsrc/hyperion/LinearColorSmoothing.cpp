@@ -1,14 +1,26 @@
 // Qt includes
 #include <QDateTime>
-#include <QTimer>
+#include <QThread>
+#include <QWaitCondition>
+#include <QMutexLocker>
 
 #include "LinearColorSmoothing.h"
 #include <hyperion/Hyperion.h>
+#include <utils/LatencyTracer.h>
+#include <utils/Profiler.h>
 
 #include <cmath>
 #include <chrono>
 #include <thread>
 
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+	#include <time.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
 /// The number of microseconds per millisecond = 1000.
 const int64_t MS_PER_MICRO = 1000;
 
@@ -21,8 +33,9 @@ const int64_t MS_PER_MICRO = 1000;
 #endif
 
 /// Clamps the rounded values to the byte-interval of [0, 255].
-ALWAYS_INLINE long clampRounded(const floatT x) {
-	return std::min(255L, std::max(0L, std::lroundf(x)));
+/// Clamps to [0, 255] before rounding, so it converts by truncation without library calls and the loops using it vectorise
+ALWAYS_INLINE uint8_t clampRounded(const floatT x) {
+	return static_cast<uint8_t>(std::min(255.0F, std::max(0.0F, x)) + 0.5F);
 }
 
 /// The number of bits that are used for shifting the fixed point values
@@ -48,13 +61,226 @@ const int DEFAUL_UPDATEFREQUENCY = 25;													// updatefrequncy in hz
 constexpr std::chrono::milliseconds DEFAUL_UPDATEINTERVALL{1000/ DEFAUL_UPDATEFREQUENCY};
 const unsigned DEFAUL_OUTPUTDEPLAY = 0;														// outputdelay in ms
 
+/// The last part of a wait is slept precisely, the part before can be interrupted to stop the output thread
+const int64_t PRECISE_SLEEP_MICROS = 2000;
+
+/// The SCHED_FIFO priority of the output thread when real-time scheduling is enabled
+const int REALTIME_PRIORITY = 10;
+
+///
+/// Runs the output steps of the smoothing at absolute deadlines, so the output cadence neither depends on the load
+/// of the instance thread nor on the resolution of a QTimer. It is idle until the first frame after a clear arrives.
+///
+class SmoothingOutputThread : public QThread
+{
+public:
+	explicit SmoothingOutputThread(LinearColorSmoothing* smoothing)
+		: QThread()
+		, _smoothing(smoothing)
+		, _intervalMicros(MS_PER_MICRO * DEFAUL_UPDATEINTERVALL.count())
+		, _active(false)
+		, _stop(false)
+		, _realtime(false)
+		, _cpu(-1)
+		, _schedulingChanged(false)
+	{
+	}
+
+	///
+	/// Sets the interval of the output steps, it applies from the next step on
+	///
+	/// @param intervalMicros The interval, the thread is idle while it is 0
+	///
+	void setInterval(int64_t intervalMicros)
+	{
+		QMutexLocker lock(&_mutex);
+		_intervalMicros = intervalMicros;
+		_condition.wakeAll();
+	}
+
+	///
+	/// Sets the scheduling of the thread, it is applied before the next step
+	///
+	/// @param realtime Use SCHED_FIFO instead of the default scheduling
+	/// @param cpu The CPU to run on, -1 for any
+	///
+	void setScheduling(bool realtime, int cpu)
+	{
+		QMutexLocker lock(&_mutex);
+		_realtime = realtime;
+		_cpu = cpu;
+		_schedulingChanged = true;
+	}
+
+	///
+	/// Starts the output steps, only locks when the thread is idle
+	///
+	void activate()
+	{
+		if (!_active.load(std::memory_order_acquire))
+		{
+			QMutexLocker lock(&_mutex);
+			_active = true;
+			_condition.wakeAll();
+		}
+	}
+
+	///
+	/// Lets the thread become idle after the current wait
+	///
+	void deactivate()
+	{
+		_active = false;
+	}
+
+	///
+	/// Stops the thread and waits for it
+	///
+	void stop()
+	{
+		{
+			QMutexLocker lock(&_mutex);
+			_stop = true;
+			_condition.wakeAll();
+		}
+		wait();
+	}
+
+protected:
+	void run() override
+	{
+		int64_t deadline = 0;
+		for (;;)
+		{
+			{
+				QMutexLocker lock(&_mutex);
+				if (isIdle() && !_stop)
+				{
+					while (isIdle() && !_stop)
+					{
+						_condition.wait(&_mutex);
+					}
+
+					// the first step after being idle is due at once
+					deadline = LinearColorSmoothing::micros();
+				}
+				if (_stop)
+				{
+					break;
+				}
+
+				if (_schedulingChanged)
+				{
+					applyScheduling();
+					_schedulingChanged = false;
+				}
+
+				// wait interruptible for the most part of a long interval
+				const int64_t coarseWait = deadline - LinearColorSmoothing::micros() - PRECISE_SLEEP_MICROS;
+				if (coarseWait > 0)
+				{
+					_condition.wait(&_mutex, static_cast<unsigned long>(coarseWait / MS_PER_MICRO));
+					if (_stop)
+					{
+						break;
+					}
+				}
+			}
+
+			sleepUntil(deadline);
+			_smoothing->updateLeds();
+
+			// keep the cadence without catching up steps that were missed
+			deadline = std::max(deadline + _intervalMicros.load(), LinearColorSmoothing::micros());
+		}
+	}
+
+private:
+	///
+	/// The thread is idle until activated, and when there is no interval to step at
+	///
+	bool isIdle() const
+	{
+		return !_active || _intervalMicros <= 0;
+	}
+
+	///
+	/// Sleeps until the given time of LinearColorSmoothing::micros()
+	///
+	static void sleepUntil(int64_t deadline)
+	{
+#if defined(__linux__)
+		// std::chrono::steady_clock is CLOCK_MONOTONIC on Linux
+		timespec time;
+		time.tv_sec = static_cast<time_t>(deadline / 1000000);
+		time.tv_nsec = static_cast<long>(deadline % 1000000) * 1000;
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) == EINTR)
+		{
+		}
+#else
+		std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(deadline)));
+#endif
+	}
+
+	void applyScheduling()
+	{
+		Logger* log = _smoothing->_log;
+#if defined(__linux__)
+		sched_param param;
+		param.sched_priority = _realtime ? REALTIME_PRIORITY : 0;
+		int error = pthread_setschedparam(pthread_self(), _realtime ? SCHED_FIFO : SCHED_OTHER, &param);
+		if (error != 0)
+		{
+			Warning(log, "Failed to set %s scheduling of the output thread: %s", _realtime ? "real-time" : "default", strerror(error));
+		}
+
+		if (_cpu >= CPU_SETSIZE)
+		{
+			Warning(log, "Invalid CPU %d for the output thread", _cpu);
+			return;
+		}
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (_cpu < 0 || cpu == _cpu)
+			{
+				CPU_SET(cpu, &cpus);
+			}
+		}
+		error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (error != 0)
+		{
+			Warning(log, "Failed to set the CPU affinity of the output thread: %s", strerror(error));
+		}
+		DebugIf(_realtime || _cpu >= 0, log, "Output thread scheduling: real-time %d, CPU %d", _realtime ? 1 : 0, _cpu);
+#else
+		WarningIf(_realtime || _cpu >= 0, log, "Real-time scheduling and CPU affinity of the output thread are not supported on this platform");
+#endif
+	}
+
+	LinearColorSmoothing* _smoothing;
+	std::atomic<int64_t> _intervalMicros;
+	std::atomic<bool> _active;
+
+	QMutex _mutex;
+	QWaitCondition _condition;
+	bool _stop;
+	bool _realtime;
+	int _cpu;
+	bool _schedulingChanged;
+};
+
 LinearColorSmoothing::LinearColorSmoothing(const QJsonDocument &config, Hyperion *hyperion)
 	: QObject(hyperion)
 	, _log(Logger::getInstance("SMOOTHING"))
 	, _hyperion(hyperion)
 	, _updateInterval(DEFAUL_UPDATEINTERVALL.count())
 	, _settlingTime(DEFAUL_SETTLINGTIME)
-	, _timer(new QTimer(this))
+	, _outputThread(new SmoothingOutputThread(this))
+	, _inboxHead(0)
+	, _inboxTail(0)
 	, _outputDelay(DEFAUL_OUTPUTDEPLAY)
 	, _smoothingType(SmoothingType::Linear)
 	, _writeToLedsEnable(false)
@@ -75,12 +301,17 @@ LinearColorSmoothing::LinearColorSmoothing(const QJsonDocument &config, Hyperion
 
 	// listen for comp changes
 	connect(_hyperion, &Hyperion::compStateChangeRequest, this, &LinearColorSmoothing::componentStateChange);
-	// timer
-	connect(_timer, &QTimer::timeout, this, &LinearColorSmoothing::updateLeds);
+
+	_outputThread->start(QThread::HighPriority);
 
 	//Debug(_log, "LinearColorSmoothing sizeof floatT == %d", (sizeof(floatT)));
 }
 
+LinearColorSmoothing::~LinearColorSmoothing()
+{
+	_outputThread->stop();
+}
+
 void LinearColorSmoothing::handleSettingsUpdate(settings::type type, const QJsonDocument &config)
 {
 	if (type == settings::SMOOTHING)
@@ -94,7 +325,12 @@ void LinearColorSmoothing::handleSettingsUpdate(settings::type type, const QJson
 			setEnable(obj["enable"].toBool(true));
 		}
 
-		_continuousOutput = obj["continuousOutput"].toBool(true);
+		{
+			QMutexLocker lock(&_stateMutex);
+			_continuousOutput = obj["continuousOutput"].toBool(true);
+		}
+
+		_outputThread->setScheduling(obj["realtimePriority"].toBool(false), obj["cpuAffinity"].toInt(-1));
 
 		SMOOTHING_CFG cfg = {SmoothingType::Linear,true, 0, 0, 0, 0, 0, false, 1};
 
@@ -133,24 +369,75 @@ void LinearColorSmoothing::handleSettingsUpdate(settings::type type, const QJson
 
 int LinearColorSmoothing::write(const std::vector<ColorRgb> &ledValues)
 {
-	_targetTime = micros() + (MS_PER_MICRO * _settlingTime);
+	// Hand the frame over to the output thread; the inbox is only full when that thread stalls, then the oldest frame
+	// is dropped to keep the newest. The output thread only takes frames while holding the lock, so the tail is
+	// advanced under it and the released slot is not read anymore.
+	const size_t head = _inboxHead.load(std::memory_order_relaxed);
+	if (head - _inboxTail.load(std::memory_order_acquire) >= _inbox.size())
+	{
+		QMutexLocker lock(&_stateMutex);
+		const size_t tail = _inboxTail.load(std::memory_order_relaxed);
+		if (head - tail >= _inbox.size())
+		{
+			_inboxTail.store(tail + 1, std::memory_order_release);
+		}
+	}
+
+	INBOX_FRAME &frame = _inbox[head % _inbox.size()];
+	frame.time = micros();
+	frame.colors = ledValues;
+	_inboxHead.store(head + 1, std::memory_order_release);
+
+	_outputThread->activate();
+
+	return 0;
+}
+
+void LinearColorSmoothing::takeFrames()
+{
+	const size_t head = _inboxHead.load(std::memory_order_acquire);
+	size_t tail = _inboxTail.load(std::memory_order_relaxed);
+
+	for (; tail != head; ++tail)
+	{
+		const INBOX_FRAME &frame = _inbox[tail % _inbox.size()];
+		acceptFrame(frame.time, frame.colors);
+	}
+
+	_inboxTail.store(tail, std::memory_order_release);
+}
+
+void LinearColorSmoothing::acceptFrame(const int64_t time, const std::vector<ColorRgb> &ledValues)
+{
+	_targetTime = time + (MS_PER_MICRO * _settlingTime);
 	_targetValues = ledValues;
 
-	rememberFrame(ledValues);
+	rememberFrame(time, ledValues);
 
 	// received a new target color
 	if (_previousValues.empty())
 	{
 		// not initialized yet
-		_previousWriteTime = micros();
+		_previousWriteTime = time;
 		_previousValues = ledValues;
-		_previousInterpolationTime = micros();
+		_previousInterpolationTime = time;
+	}
+}
 
-		//Debug( _log, "Start Smoothing timer: settlingTime: %d ms, interval: %d ms (%u Hz), updateDelay: %u frames", _settlingTime, _updateInterval, unsigned(1000.0/_updateInterval), _outputDelay );
-		QMetaObject::invokeMethod(_timer, "start", Qt::QueuedConnection, Q_ARG(int, _updateInterval));
+int64_t LinearColorSmoothing::stepIntervalMicros() const
+{
+	// An update interval of 0 indicates sub-millisecond timing, then the steps follow the interpolation and output rates
+	if (_updateInterval > 0)
+	{
+		return MS_PER_MICRO * _updateInterval;
 	}
 
-	return 0;
+	// A rate of 0 (as of the pause configuration) has no interval, without any there is no stepping
+	if (_interpolationIntervalMicros <= 0 || _outputIntervalMicros <= 0)
+	{
+		return std::max<int64_t>(0, std::max(_interpolationIntervalMicros, _outputIntervalMicros));
+	}
+	return std::max<int64_t>(1, std::min(_interpolationIntervalMicros, _outputIntervalMicros));
 }
 
 int LinearColorSmoothing::updateLedValues(const std::vector<ColorRgb> &ledValues)
@@ -179,6 +466,8 @@ void LinearColorSmoothing::intitializeComponentVectors(const size_t ledCount)
 		meanValues = std::vector<floatT>(len, 0.0F);
 		residualErrors = std::vector<floatT>(len, 0.0F);
 		tempValues = std::vector<uint64_t>(len, 0L);
+		_windowSums = std::vector<int64_t>(len, 0L);
+		_windowSumsValid = false;
 	}
 
 	// Zero the temp vector
@@ -205,9 +494,9 @@ void LinearColorSmoothing::writeFrame()
 }
 
 
-ALWAYS_INLINE int64_t LinearColorSmoothing::micros() const
+ALWAYS_INLINE int64_t LinearColorSmoothing::micros()
 {
-	const auto now = std::chrono::high_resolution_clock::now();
+	const auto now = std::chrono::steady_clock::now();
 	return (std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch())).count();
 }
 
@@ -218,31 +507,25 @@ void LinearColorSmoothing::assembleAndDitherFrame()
 		return;
 	}
 
-	// The number of leds present in each frame
-	const size_t N = _targetValues.size();
+	// The number of color components present in each frame
+	const size_t len = 3 * std::min(_targetValues.size(), _previousValues.size());
 
-	for (size_t i = 0; i < N; ++i)
+	// The components are independent of each other, so the flat arrays are processed as one vectorisable loop
+	const floatT* mean = meanValues.data();
+	floatT* residual = residualErrors.data();
+	uint8_t* prev = reinterpret_cast<uint8_t*>(_previousValues.data());
+
+	for (size_t i = 0; i < len; ++i)
 	{
 		// Add residuals for error diffusion (temporal dithering)
-		const floatT fr = meanValues[3 * i + 0] + residualErrors[3 * i + 0];
-		const floatT fg = meanValues[3 * i + 1] + residualErrors[3 * i + 1];
-		const floatT fb = meanValues[3 * i + 2] + residualErrors[3 * i + 2];
+		const floatT f = mean[i] + residual[i];
 
 		// Convert to to 8-bit value
-		const long ir = clampRounded(fr);
-		const long ig = clampRounded(fg);
-		const long ib = clampRounded(fb);
+		const uint8_t value = clampRounded(f);
+		prev[i] = value;
 
-		// Update the colors
-		ColorRgb &prev = _previousValues[i];
-		prev.red = static_cast<uint8_t>(ir);
-		prev.green = static_cast<uint8_t>(ig);
-		prev.blue = static_cast<uint8_t>(ib);
-
-		// Determine the component errors
-		residualErrors[3 * i + 0] = fr - ir;
-		residualErrors[3 * i + 1] = fg - ig;
-		residualErrors[3 * i + 2] = fb - ib;
+		// Determine the component error
+		residual[i] = f - value;
 	}
 }
 
@@ -253,21 +536,16 @@ void LinearColorSmoothing::assembleFrame()
 		return;
 	}
 
-	// The number of leds present in each frame
-	const size_t N = _targetValues.size();
+	// The number of color components present in each frame
+	const size_t len = 3 * std::min(_targetValues.size(), _previousValues.size());
 
-	for (size_t i = 0; i < N; ++i)
+	const floatT* mean = meanValues.data();
+	uint8_t* prev = reinterpret_cast<uint8_t*>(_previousValues.data());
+
+	for (size_t i = 0; i < len; ++i)
 	{
 		// Convert to to 8-bit value
-		const long ir = clampRounded(meanValues[3 * i + 0]);
-		const long ig = clampRounded(meanValues[3 * i + 1]);
-		const long ib = clampRounded(meanValues[3 * i + 2]);
-
-		// Update the colors
-		ColorRgb &prev = _previousValues[i];
-		prev.red = static_cast<uint8_t>(ir);
-		prev.green = static_cast<uint8_t>(ig);
-		prev.blue = static_cast<uint8_t>(ib);
+		prev[i] = clampRounded(mean[i]);
 	}
 }
 
@@ -302,15 +580,22 @@ void LinearColorSmoothing::interpolateFrame()
 
 	intitializeComponentVectors(N);
 
+	/// Time where the current window has started
+	const int64_t windowStart = now - (MS_PER_MICRO * _settlingTime);
+
+	if (_linearDecay)
+	{
+		interpolateLinearDecay(windowStart, now);
+		_previousInterpolationTime = now;
+		return;
+	}
+
 	/// Time where the frame has been shown
 	int64_t frameStart;
 
 	/// Time where the frame display would have ended
 	int64_t frameEnd = now;
 
-	/// Time where the current window has started
-	const int64_t windowStart = now - (MS_PER_MICRO * _settlingTime);
-
 	/// The total weight of the frames that were included in our window; sum of the individual weights
 	floatT fs = 0.0F;
 
@@ -345,6 +630,95 @@ void LinearColorSmoothing::interpolateFrame()
 	_previousInterpolationTime = now;
 }
 
+template <typename T>
+ALWAYS_INLINE void LinearColorSmoothing::addWeightedComponents(const std::vector<ColorRgb>& colors, const int64_t duration, std::vector<T>& sums) const
+{
+	// Frames of a previous LED layout may differ in size
+	const size_t len = 3 * std::min(colors.size(), _ledCount);
+	const uint8_t* components = reinterpret_cast<const uint8_t*>(colors.data());
+	T* sum = sums.data();
+
+	for (size_t i = 0; i < len; ++i)
+	{
+		sum[i] += static_cast<T>(components[i] * duration);
+	}
+}
+
+void LinearColorSmoothing::slideWindow(const int64_t windowStart)
+{
+	// The summed frames are the ones right before the newest frame, the oldest of them leave the window first
+	while (_summedFrames > 0)
+	{
+		const size_t oldest = _frameQueue.size() - 1 - _summedFrames;
+		const REMEMBERED_FRAME& frame = _frameQueue[oldest];
+		if (frame.time >= windowStart)
+		{
+			break;
+		}
+
+		// From now on it is the frame clipped by the window start, which is weighted on every interpolation
+		addWeightedComponents(frame.colors, frame.time - _frameQueue[oldest + 1].time, _windowSums);
+		--_summedFrames;
+	}
+}
+
+void LinearColorSmoothing::rebuildWindowSums(const int64_t windowStart)
+{
+	std::fill(_windowSums.begin(), _windowSums.end(), 0L);
+	_summedFrames = 0;
+
+	// All frames but the newest one that started inside the window have a fixed display time
+	for (size_t i = _frameQueue.size(); i >= 2 && _frameQueue[i - 2].time >= windowStart; --i)
+	{
+		addWeightedComponents(_frameQueue[i - 2].colors, _frameQueue[i - 1].time - _frameQueue[i - 2].time, _windowSums);
+		++_summedFrames;
+	}
+
+	_windowSumsValid = true;
+}
+
+void LinearColorSmoothing::interpolateLinearDecay(const int64_t windowStart, const int64_t now)
+{
+	if (_windowSumsValid)
+	{
+		slideWindow(windowStart);
+	}
+	else
+	{
+		rebuildWindowSums(windowStart);
+	}
+
+	const size_t len = 3 * _ledCount;
+	for (size_t i = 0; i < len; ++i)
+	{
+		meanValues[i] = static_cast<floatT>(_windowSums[i]);
+	}
+
+	// Only the newest frame, which is still displayed, and the frame clipped by the window start have a variable weight
+	const size_t frames = _frameQueue.size();
+	if (frames > 0)
+	{
+		const REMEMBERED_FRAME& newest = _frameQueue.back();
+		addWeightedComponents(newest.colors, now - std::max(newest.time, windowStart), meanValues);
+	}
+	if (frames >= _summedFrames + 2)
+	{
+		const size_t clipped = frames - 2 - _summedFrames;
+		const int64_t clippedEnd = _frameQueue[clipped + 1].time;
+		if (clippedEnd > windowStart)
+		{
+			addWeightedComponents(_frameQueue[clipped].colors, clippedEnd - std::max(_frameQueue[clipped].time, windowStart), meanValues);
+		}
+	}
+
+	// Linear weighting = display time * inverse window; the weights add up to 1 at most, so no further normalization
+	const floatT invWindow = _invWindow;
+	for (size_t i = 0; i < len; ++i)
+	{
+		meanValues[i] *= invWindow;
+	}
+}
+
 void LinearColorSmoothing::performDecay(const int64_t now) {
 	/// The target time when next frame interpolation should be performed
 	const int64_t interpolationTarget = _previousInterpolationTime + _interpolationIntervalMicros;
@@ -382,22 +756,6 @@ void LinearColorSmoothing::performDecay(const int64_t now) {
 		++_renderedCounter;
 	}
 
-	// Check for sleep when no operation is pending.
-	// As our QTimer is not capable of sub 1ms timing but instead performs spinning -
-	// we have to do µsec-sleep to free CPU time; otherwise the thread would consume 100% CPU time.
-	if(_updateInterval <= 0 && !(interpolatePending || writePending)) {
-		const int64_t nextActionExpected = std::min(interpolationTarget, writeTarget);
-		const int64_t microsTillNextAction = nextActionExpected - now;
-		const int64_t SLEEP_MAX_MICROS = 1000L; // We want to use usleep for up to 1ms
-		const int64_t SLEEP_RES_MICROS = 100L; // Expected resolution is >= 100µs on stock linux
-
-		if(microsTillNextAction > SLEEP_RES_MICROS) {
-			const int64_t wait = std::min(microsTillNextAction - SLEEP_RES_MICROS, SLEEP_MAX_MICROS);
-			//usleep(wait);
-			std::this_thread::sleep_for(std::chrono::microseconds(wait));
-		}
-	}
-
 	// Write stats every 30 sec
 	if ((now > (_renderedStatTime + 30 * 1000000)) && (_renderedCounter > _renderedStatCounter))
 	{
@@ -438,6 +796,18 @@ void LinearColorSmoothing::performLinear(const int64_t now) {
 
 void LinearColorSmoothing::updateLeds()
 {
+	PROFILER_SCOPE("LinearColorSmoothing::updateLeds")
+	const qint64 traceStart = LatencyTracer::now();
+
+	QMutexLocker lock(&_stateMutex);
+	takeFrames();
+
+	// cleared, no frame received since
+	if (_previousValues.empty())
+	{
+		return;
+	}
+
 	const int64_t now = micros();
 	const int64_t deltaTime = _targetTime - now;
 
@@ -445,29 +815,30 @@ void LinearColorSmoothing::updateLeds()
 	if (deltaTime < 0)
 	{
 		writeDirect();
-		return;
 	}
-
-	switch (_smoothingType)
+	else
 	{
-	case Decay:
-		performDecay(now);
-		break;
-
-	case Linear:
-		// Linear interpolation is default
-	default:
-		performLinear(now);
-		break;
+		switch (_smoothingType)
+		{
+		case Decay:
+			performDecay(now);
+			break;
+
+		case Linear:
+			// Linear interpolation is default
+		default:
+			performLinear(now);
+			break;
+		}
 	}
+
+	LatencyTracer::recordSince(LatencyTracer::SMOOTHING, traceStart);
 }
 
-void LinearColorSmoothing::rememberFrame(const std::vector<ColorRgb> &ledColors)
+void LinearColorSmoothing::rememberFrame(const int64_t now, const std::vector<ColorRgb> &ledColors)
 {
 	//Debug(_log, "rememberFrame -  before _frameQueue.size() [%d]", _frameQueue.size());
 
-	const int64_t now = micros();
-
 	// Maintain the queue by removing outdated frames
 	const int64_t windowStart = now - (MS_PER_MICRO * _settlingTime);
 
@@ -479,6 +850,19 @@ void LinearColorSmoothing::rememberFrame(const std::vector<ColorRgb> &ledColors)
 		++p;
 	}
 
+	// Keep the linear decay window sums in line with the queue: expire them before frames are erased,
+	// then the previous frame's display time is known and it joins the sums if it started inside the window
+	if (_windowSumsValid)
+	{
+		slideWindow(windowStart);
+
+		if (!_frameQueue.empty() && _frameQueue.back().time >= windowStart)
+		{
+			addWeightedComponents(_frameQueue.back().colors, now - _frameQueue.back().time, _windowSums);
+			++_summedFrames;
+		}
+	}
+
 	if (p > 0)
 	{
 		//Debug(_log, "rememberFrame -  erasing %d frames", p);
@@ -501,6 +885,9 @@ void LinearColorSmoothing::clearRememberedFrames()
 	meanValues.clear();
 	residualErrors.clear();
 	tempValues.clear();
+	_windowSums.clear();
+	_summedFrames = 0;
+	_windowSumsValid = false;
 }
 
 void LinearColorSmoothing::queueColors(const std::vector<ColorRgb> &ledColors)
@@ -542,17 +929,26 @@ void LinearColorSmoothing::queueColors(const std::vector<ColorRgb> &ledColors)
 
 void LinearColorSmoothing::clearQueuedColors()
 {
-	QMetaObject::invokeMethod(_timer, "stop", Qt::QueuedConnection);
+	_outputThread->deactivate();
+
+	QMutexLocker lock(&_stateMutex);
 	_previousValues.clear();
 
 	_targetValues.clear();
 
 	clearRememberedFrames();
+
+	// Frames not taken yet are cleared as well, the output thread only takes frames while holding the lock
+	_inboxTail.store(_inboxHead.load(std::memory_order_relaxed), std::memory_order_release);
 }
 
 void LinearColorSmoothing::componentStateChange(hyperion::Components component, bool state)
 {
-	_writeToLedsEnable = state;
+	{
+		QMutexLocker lock(&_stateMutex);
+		_writeToLedsEnable = state;
+	}
+
 	if (component == hyperion::COMP_LEDDEVICE)
 	{
 		clearQueuedColors();
@@ -577,6 +973,7 @@ void LinearColorSmoothing::setEnable(bool enable)
 
 void LinearColorSmoothing::setPause(bool pause)
 {
+	QMutexLocker lock(&_stateMutex);
 	_pause = pause;
 }
 
@@ -637,14 +1034,16 @@ bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 	//Debug( _log, "selectConfig FORCED - _currentConfigId [%u], force [%d]", cfg, force);
 	if (cfg < static_cast<uint>(_cfgList.count()) )
 	{
+		QMutexLocker lock(&_stateMutex);
+
 		_smoothingType = _cfgList[cfg].smoothingType;
 		_settlingTime = _cfgList[cfg].settlingTime;
 		_outputDelay = _cfgList[cfg].outputDelay;
 		_pause = _cfgList[cfg].pause;
 		_outputRate = _cfgList[cfg].outputRate;
-		_outputIntervalMicros = int64_t(1000000.0 / _outputRate); // 1s = 1e6 µs
+		_outputIntervalMicros = _outputRate > 0 ? int64_t(1000000.0 / _outputRate) : 0; // 1s = 1e6 µs
 		_interpolationRate = _cfgList[cfg].interpolationRate;
-		_interpolationIntervalMicros = int64_t(1000000.0 / _interpolationRate);
+		_interpolationIntervalMicros = _interpolationRate > 0 ? int64_t(1000000.0 / _interpolationRate) : 0;
 		_dithering = _cfgList[cfg].dithering;
 		_decay = _cfgList[cfg].decay;
 		_invWindow = 1.0F / (MS_PER_MICRO * _settlingTime);
@@ -653,8 +1052,12 @@ bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 		const float decay = _decay;
 		const floatT inv_window = _invWindow;
 
+		// The window sums depend on the window length and are only maintained for linear decay
+		_linearDecay = std::abs(decay - 1.0F) <= std::numeric_limits<float>::epsilon();
+		_windowSumsValid = false;
+
 		// For decay != 1 use power-based approach for calculating the moving average values
-		if(std::abs(decay - 1.0F) > std::numeric_limits<float>::epsilon()) {
+		if(!_linearDecay) {
 			// Exponential Decay
 			_weightFrame = [inv_window,decay](const int64_t fs, const int64_t fe, const int64_t ws) {
 				const floatT s = (fs - ws) * inv_window;
@@ -677,21 +1080,8 @@ bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 		_interpolationCounter = 0;
 		_interpolationStatCounter = 0;
 
-		if (_cfgList[cfg].updateInterval != _updateInterval)
-		{
-
-			QMetaObject::invokeMethod(_timer, "stop", Qt::QueuedConnection);
-			_updateInterval = _cfgList[cfg].updateInterval;
-			if (this->enabled() && this->_writeToLedsEnable)
-			{
-				//Debug( _log, "_cfgList[cfg].updateInterval != _updateInterval - Restart timer - _updateInterval [%d]", _updateInterval);
-				QMetaObject::invokeMethod(_timer, "start", Qt::QueuedConnection, Q_ARG(int, _updateInterval));
-			}
-			else
-			{
-				//Debug( _log, "Smoothing disabled, do NOT restart timer");
-			}
-		}
+		_updateInterval = _cfgList[cfg].updateInterval;
+		_outputThread->setInterval(stepIntervalMicros());
 		_currentConfigId = cfg;
 		// Debug( _log, "current smoothing cfg: %d, settlingTime: %d ms, interval: %d ms (%u Hz), updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateInterval, unsigned(1000.0/_updateInterval), _outputDelay );
 		//	DebugIf( enabled() && !_pause, _log, "set smoothing cfg: %u settlingTime: %d ms, interval: %d ms,  updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateInterval,  _outputDelay );
@@ -3,9 +3,13 @@
 // STL includes
 #include <vector>
 #include <deque>
+#include <array>
+#include <atomic>
+#include <memory>
 
 // Qt includes
 #include <QVector>
+#include <QMutex>
 
 // hyperion includes
 #include <leddevice/LedDevice.h>
@@ -17,9 +21,9 @@
 // The type of float
 #define floatT float // Select double, float or __fp16
 
-class QTimer;
 class Logger;
 class Hyperion;
+class SmoothingOutputThread;
 
 /// The type of smoothing to perform
 enum SmoothingType {
@@ -68,6 +72,8 @@ enum SmoothingType {
 ///           the average color values to the 8-bit RGB resolution of the LED-device. Effectively,
 ///           this performs diffusion of the residual errors across multiple egress frames.
 ///
+/// The smoothing steps run on an own output thread at absolute deadlines, optionally with real-time
+/// priority and pinned to a CPU. New frames are handed over from the instance thread without locking.
 ///
 
 class LinearColorSmoothing : public QObject
@@ -80,6 +86,7 @@ public:
 	/// @param hyperion  The hyperion parent instance
 	///
 	LinearColorSmoothing(const QJsonDocument &config, Hyperion *hyperion);
+	~LinearColorSmoothing() override;
 
 	/// LED values as input for the smoothing filter
 	///
@@ -134,9 +141,6 @@ public slots:
 	void handleSettingsUpdate(settings::type type, const QJsonDocument &config);
 
 private slots:
-	/// Timer callback which writes updated led values to the led device
-	void updateLeds();
-
 	///
 	/// @brief Handle component state changes
 	/// @param component   The component
@@ -145,6 +149,23 @@ private slots:
 	void componentStateChange(hyperion::Components component, bool state);
 
 private:
+	friend class SmoothingOutputThread;
+
+	/// Output thread callback which writes updated led values to the led device
+	void updateLeds();
+
+	/// Takes the frames handed over by write(), called on the output thread
+	void takeFrames();
+
+	/// Makes a received frame the new target and remembers it for the decay smoothing
+	///
+	/// @param time The time the frame was received
+	/// @param ledValues The color-value per led
+	void acceptFrame(const int64_t time, const std::vector<ColorRgb> &ledValues);
+
+	/// @return The interval of the output steps in microseconds
+	int64_t stepIntervalMicros() const;
+
 	/**
 	 * Pushes the colors into the output queue and popping the head to the led-device
 	 *
@@ -153,7 +174,7 @@ private:
 	void queueColors(const std::vector<ColorRgb> &ledColors);
 	void clearQueuedColors();
 
-	/// write updated values as input for the smoothing filter
+	/// write updated values as input for the smoothing filter, they are handed over to the output thread
 	///
 	/// @param ledValues The color-value per led
 	/// @return Zero on success else negative
@@ -172,8 +193,30 @@ private:
 	/// The time after which the updated led values have been fully applied (msec)
 	int64_t _settlingTime;
 
-	/// The Qt timer object
-	QTimer *_timer;
+	/// Guards the smoothing state, which is used by the output thread and configured by the instance thread
+	QMutex _stateMutex;
+
+	/// The thread running the output steps
+	std::unique_ptr<SmoothingOutputThread> _outputThread;
+
+	/// A frame handed over from the instance thread to the output thread
+	struct INBOX_FRAME
+	{
+		/// The time this frame was received
+		int64_t time = 0;
+
+		/// The led colors, the capacity is kept for the next frames
+		std::vector<ColorRgb> colors;
+	};
+
+	/// Lock free ring of frames with the instance thread as the only producer and the output thread as the only consumer
+	std::array<INBOX_FRAME, 8> _inbox;
+
+	/// The number of frames written to the inbox
+	std::atomic<size_t> _inboxHead;
+
+	/// The number of frames taken from the inbox
+	std::atomic<size_t> _inboxTail;
 
 	/// The timestamp at which the target data should be fully applied
 	int64_t _targetTime;
@@ -228,8 +271,8 @@ private:
 	/// Flag for dis/enable continuous output to led device regardless there is new data or not
 	bool _continuousOutput;
 
-	/// Flag for pausing
-	bool _pause;
+	/// Flag for pausing, read by the output thread
+	std::atomic<bool> _pause;
 
 	/// The rate at which color frames should be written to LED device.
 	double _outputRate;
@@ -285,12 +328,13 @@ private:
 	QVector<SMOOTHING_CFG> _cfgList;
 
 	unsigned _currentConfigId;
-	bool _enabled;
+	std::atomic<bool> _enabled;
 
 	/// Pushes the colors into the frame queue and cleans outdated frames from memory.
 	///
+	/// @param now The time the colors were received
 	/// @param ledColors The next colors to queue
-	void rememberFrame(const std::vector<ColorRgb> &ledColors);
+	void rememberFrame(const int64_t now, const std::vector<ColorRgb> &ledColors);
 
 	/// Frees the LED frames that were queued for calculating the moving average.
 	void clearRememberedFrames();
@@ -312,6 +356,18 @@ private:
 	/// The accumulated led color values in 64-bit fixed point domain
 	std::vector<uint64_t> tempValues;
 
+	/// Linear decay: sum of color component x display time (µs) of the frames that are completely inside the window
+	std::vector<int64_t> _windowSums;
+
+	/// Linear decay: number of frames before the newest one that are included in _windowSums
+	size_t _summedFrames = 0;
+
+	/// Linear decay: false if _windowSums have to be rebuilt from the frame queue
+	bool _windowSumsValid = false;
+
+	/// Whether the frames are weighted linearly (decay of 1), which allows incremental interpolation
+	bool _linearDecay = true;
+
 	/// Writes the target frame RGB data to the LED device without any interpolation.
 	void writeDirect();
 
@@ -329,6 +385,31 @@ private:
 	/// Prepares a frame of LED colors by interpolating using the current smoothing window
 	void interpolateFrame();
 
+	/// Prepares a frame of LED colors for linear decay from the running window sums.
+	/// Only the newest frame and the frame clipped by the window start are weighted per call.
+	///
+	/// @param windowStart The start of the current window
+	/// @param now The end of the current window
+	void interpolateLinearDecay(const int64_t windowStart, const int64_t now);
+
+	/// Removes the frames that started before the window start from the running window sums
+	///
+	/// @param windowStart The start of the current window
+	void slideWindow(const int64_t windowStart);
+
+	/// Rebuilds the running window sums from the frame queue
+	///
+	/// @param windowStart The start of the current window
+	void rebuildWindowSums(const int64_t windowStart);
+
+	/// Adds the color components of the frame multiplied by the given duration to the sums
+	///
+	/// @param colors The LED colors
+	/// @param duration The display time of the frame within the window (negative to remove it)
+	/// @param sums The sums to update
+	template <typename T>
+	void addWeightedComponents(const std::vector<ColorRgb>& colors, const int64_t duration, std::vector<T>& sums) const;
+
 	/// Performs a decay-based smoothing effect. The frames are interpolated based on their age and a given decay-power.
 	///
 	/// The ingress frames that were received during the current smoothing window are reduced using a weighted moving average
@@ -348,8 +429,8 @@ private:
 	/// @param weight The weight to use.
 	static inline void aggregateComponents(const std::vector<ColorRgb>& colors, std::vector<uint64_t>& weighted, const floatT weight);
 
-	/// Gets the current time in microseconds from high precision system clock.
-	inline int64_t micros() const;
+	/// Gets the current time in microseconds from the monotonic clock, which also schedules the output thread.
+	static inline int64_t micros();
 
 	/// The time, when the rendering statistics were logged previously
 	int64_t _renderedStatTime;
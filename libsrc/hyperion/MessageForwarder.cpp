@@ -3,6 +3,7 @@
 
 // project includes
 #include <hyperion/MessageForwarder.h>
+#include "JsonForwardConnection.h"
 
 // hyperion includes
 #include <hyperion/Hyperion.h>
@@ -11,8 +12,7 @@
 #include <utils/Logger.h>
 
 // qt includes
-#include <QTcpServer>
-#include <QTcpSocket>
+#include <QMutexLocker>
 
 #include <flatbufserver/FlatBufferConnection.h>
 
@@ -39,6 +39,17 @@ MessageForwarder::MessageForwarder(Hyperion *hyperion)
 
 MessageForwarder::~MessageForwarder()
 {
+	clearSlaves();
+}
+
+void MessageForwarder::clearSlaves()
+{
+	{
+		QMutexLocker lock(&_jsonClientsMutex);
+		qDeleteAll(_jsonClients);
+		_jsonClients.clear();
+	}
+
 	while (!_forwardClients.isEmpty())
 		delete _forwardClients.takeFirst();
 }
@@ -50,8 +61,7 @@ void MessageForwarder::handleSettingsUpdate(settings::type type, const QJsonDocu
 		// clear the current targets
 		_jsonSlaves.clear();
 		_flatSlaves.clear();
-		while (!_forwardClients.isEmpty())
-			delete _forwardClients.takeFirst();
+		clearSlaves();
 
 		// build new one
 		const QJsonObject &obj = config.object();
@@ -182,7 +192,13 @@ void MessageForwarder::addJsonSlave(const QString& slave)
 	}
 
 	if (_forwarder_enabled && !_jsonSlaves.contains(slave))
+	{
 		_jsonSlaves << slave;
+
+		// connects now and stays connected
+		QMutexLocker lock(&_jsonClientsMutex);
+		_jsonClients << new JsonForwardConnection(slave, _log, this);
+	}
 }
 
 void MessageForwarder::addFlatbufferSlave(const QString& slave)
@@ -214,28 +230,45 @@ void MessageForwarder::addFlatbufferSlave(const QString& slave)
 	{
 		_flatSlaves << slave;
 		FlatBufferConnection* flatbuf = new FlatBufferConnection("Forwarder", slave.toLocal8Bit().constData(), _priority, false);
+		// lossless, raw images are sent to targets which do not support LZ4
+		flatbuf->setImageEncoding(FlatBufferConnection::ImageEncoding::LZ4);
 		_forwardClients << flatbuf;
 	}
 }
 
 void MessageForwarder::forwardJsonMessage(const QJsonObject &message)
 {
-	if (_forwarder_enabled)
+	if (_forwarder_enabled && !_jsonClients.isEmpty())
 	{
-		QTcpSocket client;
-		for (int i=0; i<_jsonSlaves.size(); i++)
-		{
-			QStringList parts = _jsonSlaves.at(i).split(":");
-			client.connectToHost(QHostAddress(parts[0]), parts[1].toUShort());
-			if ( client.waitForConnected(500) )
-			{
-				sendJsonMessage(message,&client);
-				client.close();
-			}
-		}
+		// for hyperion classic compatibility
+		QJsonObject jsonMessage = message;
+		if (jsonMessage.contains("tan") && jsonMessage["tan"].isNull())
+			jsonMessage["tan"] = 100;
+
+		// serialize once for all slaves
+		const QByteArray serializedMessage = QJsonDocument(jsonMessage).toJson(QJsonDocument::Compact) + "\n";
+
+		// a color or image of a priority supersedes the unsent color or image of the same priority
+		const QString command = message["command"].toString();
+		const QString key = (command == "color" || command == "image")
+			? "priority:" + QString::number(message["priority"].toInt())
+			: QString();
+
+		for (JsonForwardConnection* client : _jsonClients)
+			client->send(key, serializedMessage);
 	}
 }
 
+QJsonArray MessageForwarder::getJsonSlaveStatistics() const
+{
+	QMutexLocker lock(&_jsonClientsMutex);
+
+	QJsonArray statistics;
+	for (const JsonForwardConnection* client : _jsonClients)
+		statistics.append(client->getStatistics());
+	return statistics;
+}
+
 void MessageForwarder::forwardFlatbufferMessage(const QString& name, const Image<ColorRgb> &image)
 {
 	if (_forwarder_enabled)
@@ -244,47 +277,3 @@ void MessageForwarder::forwardFlatbufferMessage(const QString& name, const Image
 			_forwardClients.at(i)->setImage(image);
 	}
 }
-
-void MessageForwarder::sendJsonMessage(const QJsonObject &message, QTcpSocket *socket)
-{
-	// for hyperion classic compatibility
-	QJsonObject jsonMessage = message;
-	if (jsonMessage.contains("tan") && jsonMessage["tan"].isNull())
-		jsonMessage["tan"] = 100;
-
-	// serialize message
-	QJsonDocument writer(jsonMessage);
-	QByteArray serializedMessage = writer.toJson(QJsonDocument::Compact) + "\n";
-
-	// write message
-	socket->write(serializedMessage);
-	if (!socket->waitForBytesWritten())
-	{
-		Debug(_log, "Error while writing data to host");
-		return;
-	}
-
-	// read reply data
-	QByteArray serializedReply;
-	while (!serializedReply.contains('\n'))
-	{
-		// receive reply
-		if (!socket->waitForReadyRead())
-		{
-			Debug(_log, "Error while writing data from host");
-			return;
-		}
-
-		serializedReply += socket->readAll();
-	}
-
-	// parse reply data
-	QJsonParseError error;
-	QJsonDocument reply = QJsonDocument::fromJson(serializedReply ,&error);
-
-	if (error.error != QJsonParseError::NoError)
-	{
-		Error(_log, "Error while parsing reply: invalid json");
-		return;
-	}
-}
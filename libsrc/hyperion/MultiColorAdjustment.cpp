@@ -2,8 +2,17 @@
 #include <utils/Logger.h>
 #include <hyperion/MultiColorAdjustment.h>
 
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+// Qt includes
+#include <QMutexLocker>
+
 MultiColorAdjustment::MultiColorAdjustment(int ledCnt)
 	: _ledAdjustments(ledCnt, nullptr)
+	, _hardwareLedCount(ledCnt)
+	, _compiledOutdated(true)
 	, _log(Logger::getInstance("ADJUSTMENT"))
 {
 }
@@ -21,8 +30,10 @@ MultiColorAdjustment::~MultiColorAdjustment()
 
 void MultiColorAdjustment::addAdjustment(ColorAdjustment * adjustment)
 {
+	QMutexLocker lock(&_mutex);
 	_adjustmentIds.push_back(adjustment->_id);
 	_adjustment.push_back(adjustment);
+	_compiledOutdated = true;
 }
 
 void MultiColorAdjustment::setAdjustmentForLed(const QString& id, int startLed, int endLed)
@@ -40,6 +51,8 @@ void MultiColorAdjustment::setAdjustmentForLed(const QString& id, int startLed,
 		endLed = static_cast<int>(_ledAdjustments.size()-1);
 	}
 
+	QMutexLocker lock(&_mutex);
+
 	// Get the identified adjustment (don't care if is nullptr)
 	ColorAdjustment * adjustment = getAdjustment(id);
 
@@ -49,6 +62,7 @@ void MultiColorAdjustment::setAdjustmentForLed(const QString& id, int startLed,
 		//Debug(_log,"_ledAdjustments [%d] -> [%p]", iLed, adjustment);
 		_ledAdjustments[iLed] = adjustment;
 	}
+	_compiledOutdated = true;
 }
 
 bool MultiColorAdjustment::verifyAdjustments() const
@@ -89,62 +103,192 @@ ColorAdjustment* MultiColorAdjustment::getAdjustment(const QString& id)
 
 void MultiColorAdjustment::setBacklightEnabled(bool enable)
 {
+	QMutexLocker lock(&_mutex);
 	for (ColorAdjustment* adjustment : _adjustment)
 	{
 		adjustment->_rgbTransform.setBackLightEnabled(enable);
 	}
 }
 
-void MultiColorAdjustment::applyAdjustment(std::vector<ColorRgb>& ledColors)
+void MultiColorAdjustment::updateAdjustments()
+{
+	QMutexLocker lock(&_mutex);
+	_compiledOutdated = true;
+}
+
+void MultiColorAdjustment::setOutputLayout(const std::vector<ColorOrder>& colorOrders, int hardwareLedCount)
+{
+	QMutexLocker lock(&_mutex);
+	_colorOrders = colorOrders;
+	_hardwareLedCount = hardwareLedCount;
+	_compiledOutdated = true;
+}
+
+void MultiColorAdjustment::compileAdjustments()
 {
-	const size_t itCnt = qMin(_ledAdjustments.size(), ledColors.size());
-	for (size_t i=0; i<itCnt; ++i)
+	_compiledAdjustments.resize(_adjustment.size());
+
+	for (size_t i=0; i<_adjustment.size(); ++i)
 	{
-		ColorAdjustment* adjustment = _ledAdjustments[i];
-		if (adjustment == nullptr)
+		ColorAdjustment* adjustment = _adjustment[i];
+		CompiledAdjustment& compiled = _compiledAdjustments[i];
+		compiled.adjustment = adjustment;
+
+		uint8_t B_RGB = 0, B_CMY = 0, B_W = 0;
+		adjustment->_rgbTransform.getBrightnessComponents(B_RGB, B_CMY, B_W);
+
+		struct { RgbChannelAdjustment* channel; uint8_t brightness; } corners[8] =
+		{
+			{ &adjustment->_rgbBlackAdjustment  , 255   },
+			{ &adjustment->_rgbRedAdjustment    , B_RGB },
+			{ &adjustment->_rgbGreenAdjustment  , B_RGB },
+			{ &adjustment->_rgbBlueAdjustment   , B_RGB },
+			{ &adjustment->_rgbCyanAdjustment   , B_CMY },
+			{ &adjustment->_rgbMagentaAdjustment, B_CMY },
+			{ &adjustment->_rgbYellowAdjustment , B_CMY },
+			{ &adjustment->_rgbWhiteAdjustment  , B_W   }
+		};
+
+		for (int corner=0; corner<8; ++corner)
+		{
+			for (int weight=0; weight<256; ++weight)
+			{
+				uint8_t* rgb = compiled.mapping[corner][weight];
+				corners[corner].channel->apply(weight, corners[corner].brightness, rgb[0], rgb[1], rgb[2]);
+			}
+		}
+	}
+
+	// group consecutive leds with the same adjustment and color order, leds without adjustment are only reordered
+	_ledSpans.clear();
+	for (size_t iLed=0; iLed<_ledAdjustments.size(); ++iLed)
+	{
+		ColorAdjustment* adjustment = _ledAdjustments[iLed];
+		const CompiledAdjustment* compiled = nullptr;
+		if (adjustment != nullptr)
+		{
+			const size_t index = std::find(_adjustment.begin(), _adjustment.end(), adjustment) - _adjustment.begin();
+			compiled = &_compiledAdjustments[index];
+		}
+
+		LedSpan span {iLed, iLed+1, compiled, {0, 1, 2}};
+		switch (iLed < _colorOrders.size() ? _colorOrders[iLed] : ColorOrder::ORDER_RGB)
+		{
+		case ColorOrder::ORDER_RGB:
+			break;
+		case ColorOrder::ORDER_BGR:
+			span.channels[0] = 2; span.channels[1] = 1; span.channels[2] = 0;
+			break;
+		case ColorOrder::ORDER_RBG:
+			span.channels[0] = 0; span.channels[1] = 2; span.channels[2] = 1;
+			break;
+		case ColorOrder::ORDER_GRB:
+			span.channels[0] = 1; span.channels[1] = 0; span.channels[2] = 2;
+			break;
+		case ColorOrder::ORDER_GBR:
+			span.channels[0] = 1; span.channels[1] = 2; span.channels[2] = 0;
+			break;
+		case ColorOrder::ORDER_BRG:
+			span.channels[0] = 2; span.channels[1] = 0; span.channels[2] = 1;
+			break;
+		}
+
+		if (!_ledSpans.empty())
 		{
-			//std::cout << "MultiColorAdjustment::applyAdjustment() - No transform set for this led : " << i << std::endl;
-			// No transform set for this led (do nothing)
+			LedSpan& last = _ledSpans.back();
+			if (last.compiled == compiled && memcmp(last.channels, span.channels, sizeof(span.channels)) == 0)
+			{
+				++last.endLed;
+				continue;
+			}
+		}
+		_ledSpans.push_back(span);
+	}
+
+	_compiledOutdated = false;
+}
+
+void MultiColorAdjustment::applyAdjustment(const std::vector<ColorRgb>& rawColors, std::vector<ColorRgb>& ledColors)
+{
+	// the compiled tables are used for the whole frame
+	QMutexLocker lock(&_mutex);
+	if (_compiledOutdated)
+	{
+		compileAdjustments();
+	}
+
+	ledColors.resize(std::max(rawColors.size(), static_cast<size_t>(std::max(_hardwareLedCount, 0))));
+
+	size_t iLed = 0;
+	for (const LedSpan& span : _ledSpans)
+	{
+		if (span.startLed >= rawColors.size())
+		{
+			break;
+		}
+
+		const size_t endLed = qMin(span.endLed, rawColors.size());
+		const uint8_t* channels = span.channels;
+
+		if (span.compiled == nullptr)
+		{
+			for (iLed=span.startLed; iLed<endLed; ++iLed)
+			{
+				const ColorRgb& color = rawColors[iLed];
+				const uint8_t rgb[3] = { color.red, color.green, color.blue };
+				ledColors[iLed] = { rgb[channels[0]], rgb[channels[1]], rgb[channels[2]] };
+			}
 			continue;
 		}
-		ColorRgb& color = ledColors[i];
 
-		uint8_t ored   = color.red;
-		uint8_t ogreen = color.green;
-		uint8_t oblue  = color.blue;
-		uint8_t B_RGB = 0, B_CMY = 0, B_W = 0;
+		const CompiledAdjustment& compiled = *span.compiled;
+		RgbTransform& rgbTransform = compiled.adjustment->_rgbTransform;
 
-		adjustment->_rgbTransform.transform(ored,ogreen,oblue);
-		adjustment->_rgbTransform.getBrightnessComponents(B_RGB, B_CMY, B_W);
+		for (iLed=span.startLed; iLed<endLed; ++iLed)
+		{
+			const ColorRgb& color = rawColors[iLed];
+
+			uint8_t ored   = color.red;
+			uint8_t ogreen = color.green;
+			uint8_t oblue  = color.blue;
+
+			rgbTransform.transform(ored,ogreen,oblue);
 
-		uint32_t nrng = (uint32_t) (255-ored)*(255-ogreen);
-		uint32_t rng  = (uint32_t) (ored)    *(255-ogreen);
-		uint32_t nrg  = (uint32_t) (255-ored)*(ogreen);
-		uint32_t rg   = (uint32_t) (ored)    *(ogreen);
-
-		uint8_t black   = nrng*(255-oblue)/65025;
-		uint8_t red     = rng *(255-oblue)/65025;
-		uint8_t green   = nrg *(255-oblue)/65025;
-		uint8_t blue    = nrng*(oblue)    /65025;
-		uint8_t cyan    = nrg *(oblue)    /65025;
-		uint8_t magenta = rng *(oblue)    /65025;
-		uint8_t yellow  = rg  *(255-oblue)/65025;
-		uint8_t white   = rg  *(oblue)    /65025;
-
-		uint8_t OR, OG, OB, RR, RG, RB, GR, GG, GB, BR, BG, BB;
-		uint8_t CR, CG, CB, MR, MG, MB, YR, YG, YB, WR, WG, WB;
-
-		adjustment->_rgbBlackAdjustment.apply  (black  , 255  , OR, OG, OB);
-		adjustment->_rgbRedAdjustment.apply    (red    , B_RGB, RR, RG, RB);
-		adjustment->_rgbGreenAdjustment.apply  (green  , B_RGB, GR, GG, GB);
-		adjustment->_rgbBlueAdjustment.apply   (blue   , B_RGB, BR, BG, BB);
-		adjustment->_rgbCyanAdjustment.apply   (cyan   , B_CMY, CR, CG, CB);
-		adjustment->_rgbMagentaAdjustment.apply(magenta, B_CMY, MR, MG, MB);
-		adjustment->_rgbYellowAdjustment.apply (yellow , B_CMY, YR, YG, YB);
-		adjustment->_rgbWhiteAdjustment.apply  (white  , B_W  , WR, WG, WB);
-
-		color.red   = OR + RR + GR + BR + CR + MR + YR + WR;
-		color.green = OG + RG + GG + BG + CG + MG + YG + WG;
-		color.blue  = OB + RB + GB + BB + CB + MB + YB + WB;
+			uint32_t nrng = (uint32_t) (255-ored)*(255-ogreen);
+			uint32_t rng  = (uint32_t) (ored)    *(255-ogreen);
+			uint32_t nrg  = (uint32_t) (255-ored)*(ogreen);
+			uint32_t rg   = (uint32_t) (ored)    *(ogreen);
+
+			const uint8_t weights[8] =
+			{
+				static_cast<uint8_t>(nrng*(255-oblue)/65025), // black
+				static_cast<uint8_t>(rng *(255-oblue)/65025), // red
+				static_cast<uint8_t>(nrg *(255-oblue)/65025), // green
+				static_cast<uint8_t>(nrng*(oblue)    /65025), // blue
+				static_cast<uint8_t>(nrg *(oblue)    /65025), // cyan
+				static_cast<uint8_t>(rng *(oblue)    /65025), // magenta
+				static_cast<uint8_t>(rg  *(255-oblue)/65025), // yellow
+				static_cast<uint8_t>(rg  *(oblue)    /65025)  // white
+			};
+
+			uint8_t rgb[3] = { 0, 0, 0 };
+			for (int corner=0; corner<8; ++corner)
+			{
+				const uint8_t* mapped = compiled.mapping[corner][weights[corner]];
+				rgb[0] += mapped[0];
+				rgb[1] += mapped[1];
+				rgb[2] += mapped[2];
+			}
+
+			// write the channels in the color order of the led
+			ledColors[iLed] = { rgb[channels[0]], rgb[channels[1]], rgb[channels[2]] };
+		}
+	}
+
+	// colors beyond the led string are passed unchanged, additional hardware leds are black
+	for (; iLed<rawColors.size(); ++iLed)
+	{
+		ledColors[iLed] = rawColors[iLed];
 	}
+	std::fill(ledColors.begin() + iLed, ledColors.end(), ColorRgb::BLACK);
 }
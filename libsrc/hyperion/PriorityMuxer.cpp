@@ -11,6 +11,7 @@
 
 // utils
 #include <utils/Logger.h>
+#include <utils/LatencyTracer.h>
 
 const int PriorityMuxer::FG_PRIORITY = 1;
 const int PriorityMuxer::BG_PRIORITY = 254;
@@ -28,7 +29,9 @@ PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	, _activeInputs()
 	, _lowestPriorityInfo()
 	, _sourceAutoSelectEnabled(true)
-	, _updateTimer(new QTimer(this))
+	, _timeoutQueue()
+	, _timeoutTimer(new QTimer(this))
+	, _enabled(true)
 	, _timer(new QTimer(this))
 	, _blockTimer(new QTimer(this))
 {
@@ -49,11 +52,23 @@ PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	// forward timeRunner signal to prioritiesChanged signal & threading workaround
 	connect(this, &PriorityMuxer::timeRunner, this, &PriorityMuxer::prioritiesChanged);
 	connect(this, &PriorityMuxer::signalTimeTrigger, this, &PriorityMuxer::timeTrigger);
+	// keep the remaining time updated while a timeout is running
+	connect(_blockTimer, &QTimer::timeout, this, [this]() {
+		for (const InputInfo& input : _activeInputs)
+		{
+			if (hasRunningTimeout(input))
+			{
+				timeTrigger();
+				break;
+			}
+		}
+	});
 
-	// start muxer timer
-	connect(_updateTimer, &QTimer::timeout, this, &PriorityMuxer::setCurrentTime);
-	_updateTimer->setInterval(250);
-	_updateTimer->start();
+	// the timeout timer is armed for the earliest timeout only, there is no polling
+	_timeoutTimer->setSingleShot(true);
+	_timeoutTimer->setTimerType(Qt::PreciseTimer);
+	connect(_timeoutTimer, &QTimer::timeout, this, &PriorityMuxer::handleTimeouts);
+	connect(this, &PriorityMuxer::signalTimeoutScheduled, this, &PriorityMuxer::armTimeoutTimer);
 }
 
 PriorityMuxer::~PriorityMuxer()
@@ -62,7 +77,8 @@ PriorityMuxer::~PriorityMuxer()
 
 void PriorityMuxer::setEnable(bool enable)
 {
-	enable ? _updateTimer->start() : _updateTimer->stop();
+	_enabled = enable;
+	enable ? handleTimeouts() : _timeoutTimer->stop();
 }
 
 bool PriorityMuxer::setSourceAutoSelectEnabled(bool enable, bool update)
@@ -122,13 +138,13 @@ bool PriorityMuxer::hasPriority(int priority) const
 	return (priority == PriorityMuxer::LOWEST_PRIORITY) ? true : _activeInputs.contains(priority);
 }
 
-PriorityMuxer::InputInfo PriorityMuxer::getInputInfo(int priority) const
+const PriorityMuxer::InputInfo& PriorityMuxer::getInputInfo(int priority) const
 {
-	auto elemIt = _activeInputs.find(priority);
-	if (elemIt == _activeInputs.end())
+	auto elemIt = _activeInputs.constFind(priority);
+	if (elemIt == _activeInputs.constEnd())
 	{
-		elemIt = _activeInputs.find(PriorityMuxer::LOWEST_PRIORITY);
-		if (elemIt == _activeInputs.end())
+		elemIt = _activeInputs.constFind(PriorityMuxer::LOWEST_PRIORITY);
+		if (elemIt == _activeInputs.constEnd())
 		{
 			// fallback
 			return _lowestPriorityInfo;
@@ -142,6 +158,28 @@ hyperion::Components PriorityMuxer::getComponentOfPriority(int priority) const
 	return _activeInputs[priority].componentId;
 }
 
+void PriorityMuxer::scheduleTimeout(int priority, int64_t previousTimeout_ms, int64_t timeout_ms)
+{
+	// an entry at or before the previous timeout is queued already and requeues itself when due
+	if (timeout_ms <= 0 || (previousTimeout_ms > 0 && previousTimeout_ms <= timeout_ms))
+	{
+		return;
+	}
+
+	_timeoutQueue.push(std::make_pair(timeout_ms, priority));
+	if (_timeoutQueue.top().second == priority && _timeoutQueue.top().first == timeout_ms)
+	{
+		// new earliest timeout; as signal to prevent Threading issues
+		emit signalTimeoutScheduled();
+	}
+}
+
+bool PriorityMuxer::hasRunningTimeout(const InputInfo& input)
+{
+	// blacklist prio 255
+	return input.priority < BG_PRIORITY && input.timeoutTime_ms > 0 && (input.componentId == hyperion::COMP_EFFECT || input.componentId == hyperion::COMP_COLOR || input.componentId == hyperion::COMP_IMAGE);
+}
+
 void PriorityMuxer::registerInput(int priority, hyperion::Components component, const QString& origin, const QString& owner, unsigned smooth_cfg)
 {
 	// detect new registers
@@ -210,6 +248,7 @@ bool PriorityMuxer::setInput(int priority, const std::vector<ColorRgb>& ledColor
 		activeChange = true;
 	}
 	// update input
+	scheduleTimeout(priority, input.timeoutTime_ms, timeout_ms);
 	input.timeoutTime_ms = timeout_ms;
 	input.ledColors      = ledColors;
 	input.image.clear();
@@ -236,6 +275,8 @@ bool PriorityMuxer::setInputImage(int priority, const Image<ColorRgb>& image, in
 		return false;
 	}
 
+	LatencyTracer::recordSince(LatencyTracer::CAPTURE_TO_MUXER, image.captureTime());
+
 	InputInfo& input = _activeInputs[priority];
 	// detect active <-> inactive changes
 	bool activeChange = false;
@@ -261,6 +302,7 @@ bool PriorityMuxer::setInputImage(int priority, const Image<ColorRgb>& image, in
 		activeChange = true;
 	}
 	// update input
+	scheduleTimeout(priority, input.timeoutTime_ms, timeout_ms);
 	input.timeoutTime_ms = timeout_ms;
 	input.image          = image;
 	input.ledColors.clear();
@@ -308,6 +350,8 @@ void PriorityMuxer::clearAll(bool forceClearAll)
 		_activeInputs.clear();
 		_currentPriority = PriorityMuxer::LOWEST_PRIORITY;
 		_activeInputs[_currentPriority] = _lowestPriorityInfo;
+		_timeoutQueue = decltype(_timeoutQueue)();
+		_timeoutTimer->stop();
 	}
 	else
 	{
@@ -343,8 +387,8 @@ void PriorityMuxer::setCurrentTime()
 			if(infoIt->timeoutTime_ms > TIMEOUT_NOT_ACTIVE_PRIO)
 				newPriority = qMin(newPriority, infoIt->priority);
 
-			// call timeTrigger when effect or color is running with timeout > 0, blacklist prio 255
-			if (infoIt->priority < BG_PRIORITY && infoIt->timeoutTime_ms > 0 && (infoIt->componentId == hyperion::COMP_EFFECT || infoIt->componentId == hyperion::COMP_COLOR || infoIt->componentId == hyperion::COMP_IMAGE))
+			// call timeTrigger when effect or color is running with timeout > 0
+			if (hasRunningTimeout(*infoIt))
 			{
 				emit signalTimeTrigger(); // as signal to prevent Threading issues
 			}
@@ -383,6 +427,55 @@ void PriorityMuxer::setCurrentTime()
 	}
 }
 
+void PriorityMuxer::handleTimeouts()
+{
+	const int64_t now = QDateTime::currentMSecsSinceEpoch();
+	bool expired = false;
+
+	while (!_timeoutQueue.empty() && _timeoutQueue.top().first <= now)
+	{
+		const int priority = _timeoutQueue.top().second;
+		_timeoutQueue.pop();
+
+		// skip priorities which were cleared or became endless meanwhile
+		auto inputIt = _activeInputs.find(priority);
+		if (inputIt == _activeInputs.end() || inputIt->timeoutTime_ms <= 0)
+		{
+			continue;
+		}
+
+		if (inputIt->timeoutTime_ms <= now)
+		{
+			expired = true;
+		}
+		else
+		{
+			// the timeout was extended meanwhile
+			_timeoutQueue.push(std::make_pair(inputIt->timeoutTime_ms, priority));
+		}
+	}
+
+	// clear the expired priorities and update _currentPriority
+	if (expired)
+	{
+		setCurrentTime();
+	}
+
+	armTimeoutTimer();
+}
+
+void PriorityMuxer::armTimeoutTimer()
+{
+	if (!_enabled || _timeoutQueue.empty())
+	{
+		_timeoutTimer->stop();
+		return;
+	}
+
+	const int64_t remaining = _timeoutQueue.top().first - QDateTime::currentMSecsSinceEpoch();
+	_timeoutTimer->start(static_cast<int>(qBound<int64_t>(0, remaining, std::numeric_limits<int>::max())));
+}
+
 void PriorityMuxer::timeTrigger()
 {
 	if(_blockTimer->isActive())
@@ -16,9 +16,15 @@
 #include <utils/version.hpp>
 using namespace semver;
 
+#include <QMutexLocker>
+
 // Constants
 namespace {
 const char DEFAULT_VERSION[] = "2.0.0-alpha.8";
+
+// settings shared by all instances (see SettingsTable::isSettingGlobal)
+QMap<QString, QJsonDocument> globalSnapshot;
+QMutex globalSnapshotMutex;
 } //End of constants
 
 QJsonObject SettingsManager::schemaJson;
@@ -81,6 +87,7 @@ SettingsManager::SettingsManager(quint8 instance, QObject* parent, bool readonly
 	// need to validate all data in database construct the entire data object
 	// TODO refactor schemaChecker to accept QJsonArray in validate(); QJsonDocument container? To validate them per entry...
 	QJsonObject dbConfig;
+	QMap<QString, QJsonDocument> dbSettings;
 	for(const auto & key : keyList)
 	{
 		QJsonDocument doc = _sTable->getSettingsRecord(key);
@@ -88,8 +95,12 @@ SettingsManager::SettingsManager(quint8 instance, QObject* parent, bool readonly
 			dbConfig[key] = doc.array();
 		else
 			dbConfig[key] = doc.object();
+		dbSettings.insert(key, doc);
 	}
 
+	// the snapshot mirrors the database from now on, saveSettings() keeps both in sync
+	updateSnapshot(dbSettings);
+
 	//Check, if database requires migration
 	bool isNewRelease = false;
 	// Use instance independent SettingsManager to track migration status
@@ -166,7 +177,7 @@ SettingsManager::SettingsManager(quint8 instance, QObject* parent, bool readonly
 
 QJsonDocument SettingsManager::getSetting(settings::type type) const
 {
-	return _sTable->getSettingsRecord(settings::typeToString(type));
+	return getSnapshotSetting(settings::typeToString(type));
 }
 
 QJsonObject SettingsManager::getSettings() const
@@ -174,8 +185,8 @@ QJsonObject SettingsManager::getSettings() const
 	QJsonObject config;
 	for(const auto & key : _qconfig.keys())
 	{
-		//Read all records from database to ensure that global settings are read across instances
-		QJsonDocument doc = _sTable->getSettingsRecord(key);
+		// global settings are taken from the shared snapshot to get the latest data across instances
+		QJsonDocument doc = getSnapshotSetting(key);
 		if(doc.isArray())
 		{
 			config.insert(key, doc.array());
@@ -188,6 +199,49 @@ QJsonObject SettingsManager::getSettings() const
 	return config;
 }
 
+QJsonDocument SettingsManager::getSnapshotSetting(const QString& key) const
+{
+	const bool global = _sTable->isSettingGlobal(key);
+	{
+		QMutexLocker lock(global ? &globalSnapshotMutex : &_snapshotMutex);
+		const QMap<QString, QJsonDocument>& snapshot = global ? globalSnapshot : _snapshot;
+		auto it = snapshot.constFind(key);
+		if (it != snapshot.constEnd())
+			return it.value();
+	}
+
+	// not part of the configuration yet, remember the database state
+	QJsonDocument doc = _sTable->getSettingsRecord(key);
+	updateSnapshot({{key, doc}});
+	return doc;
+}
+
+void SettingsManager::updateSnapshot(const QMap<QString, QJsonDocument>& settings) const
+{
+	QMap<QString, QJsonDocument> local, global;
+	for (auto it = settings.constBegin(); it != settings.constEnd(); ++it)
+	{
+		if (_sTable->isSettingGlobal(it.key()))
+			global.insert(it.key(), it.value());
+		else
+			local.insert(it.key(), it.value());
+	}
+
+	if (!local.isEmpty())
+	{
+		QMutexLocker lock(&_snapshotMutex);
+		for (auto it = local.constBegin(); it != local.constEnd(); ++it)
+			_snapshot.insert(it.key(), it.value());
+	}
+
+	if (!global.isEmpty())
+	{
+		QMutexLocker lock(&globalSnapshotMutex);
+		for (auto it = global.constBegin(); it != global.constEnd(); ++it)
+			globalSnapshot.insert(it.key(), it.value());
+	}
+}
+
 bool SettingsManager::saveSettings(QJsonObject config, bool correct)
 {
 	// optional data upgrades e.g. imported legacy/older configs
@@ -213,38 +267,40 @@ bool SettingsManager::saveSettings(QJsonObject config, bool correct)
 	// store the new config
 	_qconfig = config;
 
-	// extract keys and data
-	QStringList keyList = config.keys();
-	QStringList newValueList;
-	for(const auto & key : keyList)
+	int rc = true;
+	QMap<QString, QJsonDocument> changedSettings;
+
+	// compare the snapshot with new data to emit/save changes accordingly
+	for(const auto & key : config.keys())
 	{
+		QJsonDocument doc;
 		if(config[key].isObject())
-		{
-			newValueList << QString(QJsonDocument(config[key].toObject()).toJson(QJsonDocument::Compact));
-		}
+			doc = QJsonDocument(config[key].toObject());
 		else if(config[key].isArray())
-		{
-			newValueList << QString(QJsonDocument(config[key].toArray()).toJson(QJsonDocument::Compact));
-		}
-	}
+			doc = QJsonDocument(config[key].toArray());
+		else
+			continue;
 
-	int rc = true;
-	// compare database data with new data to emit/save changes accordingly
-	for(const auto & key : keyList)
-	{
-		QString data = newValueList.takeFirst();
-		if(_sTable->getSettingsRecordString(key) != data)
+		if(getSnapshotSetting(key) != doc)
 		{
-			if ( ! _sTable->createSettingsRecord(key, data) )
+			// write through, the snapshot only follows successful database updates
+			if ( ! _sTable->createSettingsRecord(key, QString(doc.toJson(QJsonDocument::Compact))) )
 			{
 				rc = false;
 			}
 			else
 			{
-				emit settingsChanged(settings::stringToType(key), QJsonDocument::fromJson(data.toLocal8Bit()));
+				changedSettings.insert(key, doc);
 			}
 		}
 	}
+
+	// publish all changes at once before anyone gets notified
+	updateSnapshot(changedSettings);
+
+	for (auto it = changedSettings.constBegin(); it != changedSettings.constEnd(); ++it)
+		emit settingsChanged(settings::stringToType(it.key()), it.value());
+
 	return rc;
 }
 
@@ -9,6 +9,8 @@
 // util
 #include <hyperion/Hyperion.h>
 #include <utils/JsonUtils.h>
+#include <utils/LatencyTracer.h>
+#include <utils/Profiler.h>
 
 // qt
 #include <QMutexLocker>
@@ -23,6 +25,14 @@ LedDeviceWrapper::LedDeviceWrapper(Hyperion* hyperion)
 	, _hyperion(hyperion)
 	, _ledDevice(nullptr)
 	, _enabled(false)
+	, _writePending(false)
+	, _pendingTimestamp(0)
+	, _captureTime(0)
+	, _pendingCaptureTime(0)
+	, _writtenFrames(0)
+	, _droppedFrames(0)
+	, _lastQueueAge(0)
+	, _maxQueueAge(0)
 {
 	// prepare the device constructor map
 	#define REGISTER(className) LedDeviceWrapper::addToDeviceMap(QString(#className).toLower(), LedDevice##className::construct);
@@ -50,28 +60,115 @@ void LedDeviceWrapper::createLedDevice(const QJsonObject& config)
 	// create thread and device
 	QThread* thread = new QThread(this);
 	thread->setObjectName("LedDeviceThread");
-	_ledDevice = LedDeviceFactory::construct(config);
-	_ledDevice->moveToThread(thread);
+	LedDevice* ledDevice = LedDeviceFactory::construct(config);
+	ledDevice->moveToThread(thread);
 	// setup thread management
-	connect(thread, &QThread::started, _ledDevice, &LedDevice::start);
+	connect(thread, &QThread::started, ledDevice, &LedDevice::start);
 
 	// further signals
-	connect(this, &LedDeviceWrapper::updateLeds, _ledDevice, &LedDevice::updateLeds, Qt::QueuedConnection);
+	connect(this, &LedDeviceWrapper::ledValuesPending, ledDevice, [this]() { writePendingLeds(); }, Qt::QueuedConnection);
 
-	connect(this, &LedDeviceWrapper::enable, _ledDevice, &LedDevice::enable);
-	connect(this, &LedDeviceWrapper::disable, _ledDevice, &LedDevice::disable);
+	connect(this, &LedDeviceWrapper::enable, ledDevice, &LedDevice::enable);
+	connect(this, &LedDeviceWrapper::disable, ledDevice, &LedDevice::disable);
 
-	connect(this, &LedDeviceWrapper::switchOn, _ledDevice, &LedDevice::switchOn);
-	connect(this, &LedDeviceWrapper::switchOff, _ledDevice, &LedDevice::switchOff);
+	connect(this, &LedDeviceWrapper::switchOn, ledDevice, &LedDevice::switchOn);
+	connect(this, &LedDeviceWrapper::switchOff, ledDevice, &LedDevice::switchOff);
 
-	connect(this, &LedDeviceWrapper::stopLedDevice, _ledDevice, &LedDevice::stop, Qt::BlockingQueuedConnection);
+	connect(this, &LedDeviceWrapper::stopLedDevice, ledDevice, &LedDevice::stop, Qt::BlockingQueuedConnection);
 
-	connect(_ledDevice, &LedDevice::enableStateChanged, this, &LedDeviceWrapper::handleInternalEnableState, Qt::QueuedConnection);
+	connect(ledDevice, &LedDevice::enableStateChanged, this, &LedDeviceWrapper::handleInternalEnableState, Qt::QueuedConnection);
+
+	// a new device starts with an empty mailbox, the device is published under the lock as updateLeds() runs on other threads
+	{
+		QMutexLocker lock(&_mailboxMutex);
+		_ledDevice = ledDevice;
+		_pendingLedValues.clear();
+		_writePending = false;
+	}
 
 	// start the thread
 	thread->start();
 }
 
+void LedDeviceWrapper::updateLeds(const std::vector<ColorRgb>& ledValues)
+{
+	bool notify = false;
+	{
+		QMutexLocker lock(&_mailboxMutex);
+		if(_ledDevice == nullptr)
+		{
+			return;
+		}
+
+		if (_writePending)
+		{
+			// the device thread did not pick up the previous frame yet, replace it
+			++_droppedFrames;
+		}
+		else
+		{
+			_writePending = true;
+			notify = true;
+		}
+		_pendingLedValues = ledValues;
+		_pendingTimestamp = LatencyTracer::now();
+		_pendingCaptureTime = _captureTime;
+	}
+
+	if (notify)
+	{
+		emit ledValuesPending();
+	}
+}
+
+void LedDeviceWrapper::setCaptureTime(qint64 captureTime)
+{
+	QMutexLocker lock(&_mailboxMutex);
+	_captureTime = captureTime;
+}
+
+void LedDeviceWrapper::writePendingLeds()
+{
+	qint64 captureTime = 0;
+	qint64 queueAge = 0;
+	{
+		QMutexLocker lock(&_mailboxMutex);
+		if (!_writePending)
+		{
+			return;
+		}
+
+		// swap buffers, both keep their capacity for the next frames
+		_writeLedValues.swap(_pendingLedValues);
+		_writePending = false;
+
+		queueAge = LatencyTracer::now() - _pendingTimestamp;
+		_lastQueueAge = queueAge;
+		_maxQueueAge = qMax(_maxQueueAge, queueAge);
+		++_writtenFrames;
+		captureTime = _pendingCaptureTime;
+	}
+	LatencyTracer::record(LatencyTracer::DEVICE_QUEUE, queueAge);
+
+	PROFILER_SCOPE("LedDevice::updateLeds")
+	const qint64 writeStart = LatencyTracer::now();
+	_ledDevice->updateLeds(_writeLedValues);
+	LatencyTracer::recordSince(LatencyTracer::DEVICE_WRITE, writeStart);
+	LatencyTracer::recordSince(LatencyTracer::END_TO_END, captureTime);
+}
+
+QJsonObject LedDeviceWrapper::getMailboxStatistics() const
+{
+	QMutexLocker lock(&_mailboxMutex);
+
+	QJsonObject stats;
+	stats["writtenFrames"] = static_cast<double>(_writtenFrames);
+	stats["droppedFrames"] = static_cast<double>(_droppedFrames);
+	stats["lastQueueAge"] = _lastQueueAge / 1000.0;
+	stats["maxQueueAge"] = _maxQueueAge / 1000.0;
+	return stats;
+}
+
 QJsonObject LedDeviceWrapper::getLedDeviceSchemas()
 {
 	// make sure the resources are loaded (they may be left out after static linking)
@@ -200,7 +297,12 @@ void LedDeviceWrapper::stopDeviceThread()
 	oldThread->wait();
 	delete oldThread;
 
-	disconnect(_ledDevice, nullptr, nullptr, nullptr);
-	delete _ledDevice;
-	_ledDevice = nullptr;
+	LedDevice* ledDevice = nullptr;
+	{
+		QMutexLocker lock(&_mailboxMutex);
+		ledDevice = _ledDevice;
+		_ledDevice = nullptr;
+	}
+	disconnect(ledDevice, nullptr, nullptr, nullptr);
+	delete ledDevice;
 }
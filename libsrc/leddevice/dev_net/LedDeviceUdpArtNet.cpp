@@ -32,39 +32,78 @@ bool LedDeviceUdpArtNet::init(const QJsonObject &deviceConfig)
 	{
 		_artnet_universe = deviceConfig["universe"].toInt(1);
 		_artnet_channelsPerFixture = deviceConfig["channelsPerFixture"].toInt(3);
+		_preparedChannelCount = -1;
 
 		isInitOK = true;
 	}
 	return isInitOK;
 }
 
-// populates the headers
-void LedDeviceUdpArtNet::prepare(unsigned this_universe, unsigned this_sequence, unsigned this_dmxChannelCount)
+// populates the headers, the packet is zero initialized
+void LedDeviceUdpArtNet::prepare(artnet_packet_t & artnet_packet, unsigned this_universe, unsigned this_dmxChannelCount)
 {
-// WTF? why do the specs say:
-// "This value should be an even number in the range 2 – 512. "
-	if (this_dmxChannelCount & 0x1)
-	{
-		this_dmxChannelCount++;
-	}
-
 	memcpy (artnet_packet.ID, "Art-Net\0", 8);
 
 	artnet_packet.OpCode	= htons(0x0050);	// OpOutput / OpDmx
 	artnet_packet.ProtVer	= htons(0x000e);
-	artnet_packet.Sequence	= this_sequence;
 	artnet_packet.Physical	= 0;
 	artnet_packet.SubUni	= this_universe & 0xff ;
 	artnet_packet.Net	= (this_universe >> 8) & 0x7f;
 	artnet_packet.Length	= htons(this_dmxChannelCount);
 }
 
+void LedDeviceUdpArtNet::prepareDatagrams()
+{
+	// the channel count of each universe, fixtures may have unused channels between the rgb values
+	std::vector<unsigned> channelCounts;
+	int dmxIdx = 0;
+	for (unsigned int ledIdx = 0; ledIdx < _ledRGBCount; ledIdx++)
+	{
+		dmxIdx++;
+		if ( (ledIdx % 3 == 2) && (ledIdx > 0) )
+		{
+			dmxIdx += (_artnet_channelsPerFixture-3);
+		}
+
+		if ( (ledIdx == _ledRGBCount-1) || (dmxIdx >= DMX_MAX) )
+		{
+// WTF? why do the specs say:
+// "This value should be an even number in the range 2 – 512. "
+			channelCounts.push_back(qMin((dmxIdx + 1) & ~1, DMX_MAX));
+			dmxIdx = 0;
+		}
+	}
+
+	std::vector<unsigned> sizes;
+	for (unsigned channelCount : channelCounts)
+	{
+		sizes.push_back(18 + channelCount);
+	}
+	setDatagramSizes(sizes);
+
+	for (size_t universe = 0; universe < channelCounts.size(); universe++)
+	{
+		prepare(*reinterpret_cast<artnet_packet_t*>(datagram(static_cast<int>(universe))), _artnet_universe + universe, channelCounts[universe]);
+	}
+
+	_preparedChannelCount = static_cast<int>(_ledRGBCount);
+}
+
 int LedDeviceUdpArtNet::write(const std::vector<ColorRgb> &ledValues)
 {
-	int retVal            = 0;
-	int thisUniverse	= _artnet_universe;
 	const uint8_t * rawdata = reinterpret_cast<const uint8_t *>(ledValues.data());
 
+	// the headers only change with the number of universes
+	if (_preparedChannelCount != static_cast<int>(_ledRGBCount))
+	{
+		prepareDatagrams();
+	}
+
+	if (datagramCount() == 0)
+	{
+		return 0;
+	}
+
 /*
 This field is incremented in the range 0x01 to 0xff to allow the receiving node to resequence packets.
 The Sequence field is set to 0x00 to disable this feature.
@@ -74,30 +113,42 @@ The Sequence field is set to 0x00 to disable this feature.
 		_artnet_seq = 1;
 	}
 
-	int dmxIdx = 0;			// offset into the current dmx packet
-
-	memset(artnet_packet.raw, 0, sizeof(artnet_packet.raw));
-	for (unsigned int ledIdx = 0; ledIdx < _ledRGBCount; ledIdx++)
+	if (_artnet_channelsPerFixture == 3)
 	{
-
-		artnet_packet.Data[dmxIdx++] = rawdata[ledIdx];
-		if ( (ledIdx % 3 == 2) && (ledIdx > 0) )
+		// continuous rgb values, fill each universe at once
+		for (int universe = 0; universe < datagramCount(); universe++)
 		{
-			dmxIdx += (_artnet_channelsPerFixture-3);
+			artnet_packet_t & artnet_packet = *reinterpret_cast<artnet_packet_t*>(datagram(universe));
+			artnet_packet.Sequence = _artnet_seq;
+			memcpy(artnet_packet.Data, rawdata + universe * DMX_MAX, qMin(static_cast<int>(_ledRGBCount) - universe * DMX_MAX, DMX_MAX));
 		}
-
-//     is this the   last byte of last packet   ||   last byte of other packets
-		if ( (ledIdx == _ledRGBCount-1) || (dmxIdx >= DMX_MAX) )
+	}
+	else
+	{
+		int universe = 0;
+		int dmxIdx = 0;			// offset into the current dmx packet
+		artnet_packet_t * artnet_packet = reinterpret_cast<artnet_packet_t*>(datagram(universe));
+		for (unsigned int ledIdx = 0; ledIdx < _ledRGBCount; ledIdx++)
 		{
-			prepare(thisUniverse, _artnet_seq, dmxIdx);
-			retVal &= writeBytes(18 + qMin(dmxIdx, DMX_MAX), artnet_packet.raw);
+			artnet_packet->Data[dmxIdx++] = rawdata[ledIdx];
+			if ( (ledIdx % 3 == 2) && (ledIdx > 0) )
+			{
+				dmxIdx += (_artnet_channelsPerFixture-3);
+			}
 
-			memset(artnet_packet.raw, 0, sizeof(artnet_packet.raw));
-			thisUniverse ++;
-			dmxIdx = 0;
+//     is this the   last byte of last packet   ||   last byte of other packets
+			if ( (ledIdx == _ledRGBCount-1) || (dmxIdx >= DMX_MAX) )
+			{
+				artnet_packet->Sequence = _artnet_seq;
+				if (++universe < datagramCount())
+				{
+					artnet_packet = reinterpret_cast<artnet_packet_t*>(datagram(universe));
+				}
+				dmxIdx = 0;
+			}
 		}
-
 	}
 
-	return retVal;
+	// all universes at once
+	return writeDatagrams();
 }
@@ -80,9 +80,15 @@ private:
 	///
 	/// @brief Generate Art-Net communication header
 	///
-	void prepare(unsigned this_universe, unsigned this_sequence, unsigned this_dmxChannelCount);
+	void prepare(artnet_packet_t & artnet_packet, unsigned this_universe, unsigned this_dmxChannelCount);
 
-	artnet_packet_t artnet_packet;
+	///
+	/// @brief Set up one datagram per universe with its header
+	///
+	void prepareDatagrams();
+
+	/// channel count the datagrams are prepared for
+	int _preparedChannelCount = -1;
 	uint8_t _artnet_seq = 1;
 	int _artnet_channelsPerFixture = 3;
 	int _artnet_universe = 1;
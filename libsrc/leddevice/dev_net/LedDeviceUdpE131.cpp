@@ -13,10 +13,10 @@ const ushort E131_DEFAULT_PORT = 5568;
 
 /* defined parameters from http://tsp.esta.org/tsp/documents/docs/BSR_E1-31-20xx_CP-2014-1009r2.pdf */
 const uint32_t VECTOR_ROOT_E131_DATA = 0x00000004;
-//#define VECTOR_ROOT_E131_EXTENDED               0x00000008
+const uint32_t VECTOR_ROOT_E131_EXTENDED = 0x00000008;
 const uint8_t VECTOR_DMP_SET_PROPERTY = 0x02;
 const uint32_t VECTOR_E131_DATA_PACKET = 0x00000002;
-//#define VECTOR_E131_EXTENDED_SYNCHRONIZATION    0x00000001
+const uint32_t VECTOR_E131_EXTENDED_SYNCHRONIZATION = 0x00000001;
 //#define VECTOR_E131_EXTENDED_DISCOVERY          0x00000002
 //#define VECTOR_UNIVERSE_DISCOVERY_UNIVERSE_LIST 0x00000001
 //#define E131_E131_UNIVERSE_DISCOVERY_INTERVAL   10         // seconds
@@ -44,6 +44,8 @@ bool LedDeviceUdpE131::init(const QJsonObject &deviceConfig)
 	if ( ProviderUdp::init(deviceConfig) )
 	{
 		_e131_universe = deviceConfig["universe"].toInt(1);
+		_e131_sync_universe = deviceConfig["syncUniverse"].toInt(0);
+		_preparedChannelCount = -1;
 		_e131_source_name = deviceConfig["source-name"].toString("hyperion on "+QHostInfo::localHostName());
 		QString _json_cid = deviceConfig["cid"].toString("");
 
@@ -70,11 +72,9 @@ bool LedDeviceUdpE131::init(const QJsonObject &deviceConfig)
 	return isInitOK;
 }
 
-// populates the headers
-void LedDeviceUdpE131::prepare(unsigned this_universe, unsigned this_dmxChannelCount)
+// populates the headers, the packet is zero initialized
+void LedDeviceUdpE131::prepare(e131_packet_t & e131_packet, unsigned this_universe, unsigned this_dmxChannelCount)
 {
-	memset(e131_packet.raw, 0, sizeof(e131_packet.raw));
-
 	/* Root Layer */
 	e131_packet.preamble_size = htons(16);
 	e131_packet.postamble_size = 0;
@@ -88,7 +88,7 @@ void LedDeviceUdpE131::prepare(unsigned this_universe, unsigned this_dmxChannelC
 	e131_packet.frame_vector = htonl(VECTOR_E131_DATA_PACKET);
 	snprintf (e131_packet.source_name, sizeof(e131_packet.source_name), "%s", QSTRING_CSTR(_e131_source_name) );
 	e131_packet.priority = 100;
-	e131_packet.reserved = htons(0);
+	e131_packet.sync_address = htons(_e131_sync_universe);	// receivers hold the data until the synchronization packet
 	e131_packet.options = 0;	// Bit 7 =  Preview_Data
 					// Bit 6 =  Stream_Terminated
 					// Bit 5 = Force_Synchronization
@@ -105,43 +105,75 @@ void LedDeviceUdpE131::prepare(unsigned this_universe, unsigned this_dmxChannelC
 	e131_packet.property_values[0] = 0;	// start code
 }
 
+void LedDeviceUdpE131::prepareDatagrams()
+{
+	const int dmxChannelCount = _ledRGBCount;
+	const int universeCount = (dmxChannelCount + DMX_MAX - 1) / DMX_MAX;
+
+	std::vector<unsigned> sizes;
+	for (int universe = 0; universe < universeCount; universe++)
+	{
+		sizes.push_back(E131_DMP_DATA + 1 + qMin(dmxChannelCount - universe * DMX_MAX, DMX_MAX));
+	}
+	if (_e131_sync_universe > 0)
+	{
+		sizes.push_back(sizeof(e131_sync_packet_t));
+	}
+	setDatagramSizes(sizes);
+
+	for (int universe = 0; universe < universeCount; universe++)
+	{
+		prepare(*reinterpret_cast<e131_packet_t*>(datagram(universe)), _e131_universe + universe, sizes[universe] - E131_DMP_DATA - 1);
+	}
+
+	if (_e131_sync_universe > 0)
+	{
+		e131_sync_packet_t & sync_packet = *reinterpret_cast<e131_sync_packet_t*>(datagram(universeCount));
+
+		/* Root Layer */
+		sync_packet.preamble_size = htons(16);
+		sync_packet.postamble_size = 0;
+		memcpy (sync_packet.acn_id, _acn_id, 12);
+		sync_packet.root_flength = htons(0x7000 | (sizeof(e131_sync_packet_t) - 16));
+		sync_packet.root_vector = htonl(VECTOR_ROOT_E131_EXTENDED);
+		memcpy (sync_packet.cid, _e131_cid.toRfc4122().constData() , sizeof(sync_packet.cid) );
+
+		/* Synchronization Framing Layer */
+		sync_packet.frame_flength = htons(0x7000 | (sizeof(e131_sync_packet_t) - 38));
+		sync_packet.frame_vector = htonl(VECTOR_E131_EXTENDED_SYNCHRONIZATION);
+		sync_packet.sync_address = htons(_e131_sync_universe);
+		sync_packet.reserved = 0;
+	}
+
+	_preparedChannelCount = dmxChannelCount;
+}
+
 int LedDeviceUdpE131::write(const std::vector<ColorRgb> &ledValues)
 {
-	int retVal            = 0;
-	int thisChannelCount = 0;
-	int dmxChannelCount  = _ledRGBCount;
+	const int dmxChannelCount = _ledRGBCount;
 	const uint8_t * rawdata = reinterpret_cast<const uint8_t *>(ledValues.data());
 
-	_e131_seq++;
-
-	for (int rawIdx = 0; rawIdx < dmxChannelCount; rawIdx++)
+	// the headers only change with the number of universes
+	if (_preparedChannelCount != dmxChannelCount)
 	{
-		if (rawIdx % DMX_MAX == 0) // start of new packet
-		{
-			thisChannelCount = (dmxChannelCount - rawIdx < DMX_MAX) ? dmxChannelCount % DMX_MAX : DMX_MAX;
-//			                       is this the last packet?         ?       ^^ last packet      : ^^ earlier packets
+		prepareDatagrams();
+	}
 
-			prepare(_e131_universe + rawIdx / DMX_MAX, thisChannelCount);
-			e131_packet.sequence_number = _e131_seq;
-		}
+	_e131_seq++;
 
-		e131_packet.property_values[1 + rawIdx%DMX_MAX] = rawdata[rawIdx];
+	const int universeCount = (dmxChannelCount + DMX_MAX - 1) / DMX_MAX;
+	for (int universe = 0; universe < universeCount; universe++)
+	{
+		e131_packet_t & e131_packet = *reinterpret_cast<e131_packet_t*>(datagram(universe));
+		e131_packet.sequence_number = _e131_seq;
+		memcpy(&e131_packet.property_values[1], rawdata + universe * DMX_MAX, qMin(dmxChannelCount - universe * DMX_MAX, DMX_MAX));
+	}
 
-//     is this the      last byte of last packet    ||   last byte of other packets
-		if ( (rawIdx == dmxChannelCount-1) || (rawIdx %DMX_MAX == DMX_MAX-1) )
-		{
-#undef e131debug
-#if e131debug
-			Debug (_log, "send packet: rawidx %d dmxchannelcount %d universe: %d, packetsz %d"
-				, rawIdx
-				, dmxChannelCount
-				, _e131_universe + rawIdx / DMX_MAX
-				, E131_DMP_DATA + 1 + thisChannelCount
-				);
-#endif
-			retVal &= writeBytes(E131_DMP_DATA + 1 + thisChannelCount, e131_packet.raw);
-		}
+	if (_e131_sync_universe > 0)
+	{
+		reinterpret_cast<e131_sync_packet_t*>(datagram(universeCount))->sequence_number = _e131_seq;
 	}
 
-	return retVal;
+	// all universes (and the synchronization packet) at once
+	return writeDatagrams();
 }
@@ -63,7 +63,7 @@ typedef union
 		uint32_t frame_vector;
 		char     source_name[64];
 		uint8_t  priority;
-		uint16_t reserved;
+		uint16_t sync_address;	// reserved before E1.31-2016
 		uint8_t  sequence_number;
 		uint8_t  options;
 		uint16_t universe;
@@ -82,6 +82,32 @@ typedef union
 	uint8_t raw[638];
 } e131_packet_t;
 
+/* E1.31 Universe Synchronization Packet Structure */
+typedef union
+{
+#pragma pack(push, 1)
+	struct
+	{
+		/* Root Layer */
+		uint16_t preamble_size;
+		uint16_t postamble_size;
+		uint8_t  acn_id[12];
+		uint16_t root_flength;
+		uint32_t root_vector;
+		char     cid[16];
+
+		/* Synchronization Framing Layer */
+		uint16_t frame_flength;
+		uint32_t frame_vector;
+		uint8_t  sequence_number;
+		uint16_t sync_address;
+		uint16_t reserved;
+	};
+#pragma pack(pop)
+
+	uint8_t raw[49];
+} e131_sync_packet_t;
+
 ///
 /// Implementation of the LedDevice interface for sending led colors via udp/E1.31 packets
 ///
@@ -125,10 +151,18 @@ private:
 	///
 	/// @brief Generate E1.31 communication header
 	///
-	void prepare(unsigned this_universe, unsigned this_dmxChannelCount);
+	void prepare(e131_packet_t & e131_packet, unsigned this_universe, unsigned this_dmxChannelCount);
+
+	///
+	/// @brief Set up one datagram per universe (and the synchronization packet) with their headers
+	///
+	void prepareDatagrams();
 
-	e131_packet_t e131_packet;
+	/// channel count the datagrams are prepared for
+	int _preparedChannelCount = -1;
 	uint8_t _e131_seq = 0;
+	/// universe of the synchronization packets, 0 to disable synchronization
+	int _e131_sync_universe = 0;
 	uint8_t _e131_universe = 1;
 	uint8_t _acn_id[12] = {0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00 };
 	QString _e131_source_name;
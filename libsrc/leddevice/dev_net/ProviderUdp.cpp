@@ -5,6 +5,11 @@
 #include <exception>
 // Linux includes
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <cerrno>
+#endif
 
 #include <QStringList>
 #include <QUdpSocket>
@@ -20,6 +25,7 @@ ProviderUdp::ProviderUdp(const QJsonObject& deviceConfig)
 	  , _udpSocket(nullptr)
 	  , _port(1)
 	  , _defaultHost("127.0.0.1")
+	  , _destinationSocket(-1)
 {
 	_latchTime_ms = 0;
 }
@@ -153,3 +159,113 @@ int ProviderUdp::writeBytes(const QByteArray& bytes)
 	}
 	return  rc;
 }
+
+void ProviderUdp::setDatagramSizes(const std::vector<unsigned>& sizes)
+{
+	_datagrams.resize(sizes.size());
+	for (size_t i = 0; i < sizes.size(); ++i)
+	{
+		_datagrams[i].assign(sizes[i], 0);
+	}
+}
+
+bool ProviderUdp::updateDestination(qintptr socket)
+{
+#ifdef __linux__
+	if (socket == _destinationSocket && !_destination.isEmpty())
+	{
+		return true;
+	}
+
+	// Qt binds QHostAddress::Any as dual stack IPv6 socket, IPv4 targets are addressed as mapped IPv6 address then
+	sockaddr_storage local;
+	socklen_t localLength = sizeof(local);
+	if (getsockname(static_cast<int>(socket), reinterpret_cast<sockaddr*>(&local), &localLength) != 0)
+	{
+		return false;
+	}
+
+	if (local.ss_family == AF_INET && _address.protocol() == QAbstractSocket::IPv4Protocol)
+	{
+		sockaddr_in destination {};
+		destination.sin_family = AF_INET;
+		destination.sin_port = htons(_port);
+		destination.sin_addr.s_addr = htonl(_address.toIPv4Address());
+		_destination = QByteArray(reinterpret_cast<const char*>(&destination), sizeof(destination));
+	}
+	else if (local.ss_family == AF_INET6)
+	{
+		const QHostAddress address = (_address.protocol() == QAbstractSocket::IPv4Protocol)
+			? QHostAddress("::ffff:" + _address.toString())
+			: _address;
+		const Q_IPV6ADDR ipv6 = address.toIPv6Address();
+
+		sockaddr_in6 destination {};
+		destination.sin6_family = AF_INET6;
+		destination.sin6_port = htons(_port);
+		memcpy(&destination.sin6_addr, ipv6.c, sizeof(ipv6.c));
+		_destination = QByteArray(reinterpret_cast<const char*>(&destination), sizeof(destination));
+	}
+	else
+	{
+		return false;
+	}
+
+	_destinationSocket = socket;
+	return true;
+#else
+	Q_UNUSED(socket);
+	return false;
+#endif
+}
+
+int ProviderUdp::writeDatagrams()
+{
+#ifdef __linux__
+	const qintptr socket = _udpSocket->socketDescriptor();
+	if (socket != -1 && updateDestination(socket))
+	{
+		const int BATCH_SIZE = 64;
+		mmsghdr messages[BATCH_SIZE];
+		iovec vectors[BATCH_SIZE];
+
+		size_t sent = 0;
+		while (sent < _datagrams.size())
+		{
+			const int count = static_cast<int>(qMin(_datagrams.size() - sent, static_cast<size_t>(BATCH_SIZE)));
+			for (int i = 0; i < count; ++i)
+			{
+				std::vector<uint8_t>& data = _datagrams[sent + i];
+				vectors[i].iov_base = data.data();
+				vectors[i].iov_len = data.size();
+
+				memset(&messages[i], 0, sizeof(messages[i]));
+				messages[i].msg_hdr.msg_name = _destination.data();
+				messages[i].msg_hdr.msg_namelen = static_cast<socklen_t>(_destination.size());
+				messages[i].msg_hdr.msg_iov = &vectors[i];
+				messages[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			const int result = sendmmsg(static_cast<int>(socket), messages, static_cast<unsigned>(count), 0);
+			if (result <= 0)
+			{
+				Warning(_log, "%s", QSTRING_CSTR(QString("(%1:%2) Write Error: (%3) %4").arg(_address.toString()).arg(_port).arg(errno).arg(strerror(errno))));
+				return -1;
+			}
+			sent += static_cast<size_t>(result);
+		}
+		return 0;
+	}
+#endif
+
+	// one datagram after the other
+	int rc = 0;
+	for (const auto& data : _datagrams)
+	{
+		if (writeBytes(static_cast<unsigned>(data.size()), data.data()) < 0)
+		{
+			rc = -1;
+		}
+	}
+	return rc;
+}
@@ -11,6 +11,9 @@
 #include <QHostAddress>
 #include <QUdpSocket>
 
+// STL includes
+#include <vector>
+
 ///
 /// The ProviderUdp implements an abstract base-class for LedDevices using UDP packets.
 ///
@@ -73,11 +76,55 @@ protected:
 	///
 	int writeBytes(const QByteArray& bytes);
 
+	///
+	/// @brief Set up the datagrams sent together by writeDatagrams(), all are zero initialized.
+	/// The content is kept between frames, so headers are written once and only the payload is updated in place.
+	///
+	/// @param[in] sizes The size of each datagram
+	///
+	void setDatagramSizes(const std::vector<unsigned>& sizes);
+
+	///
+	/// @return The number of datagrams set up by setDatagramSizes()
+	///
+	int datagramCount() const { return static_cast<int>(_datagrams.size()); }
+
+	///
+	/// @brief Get a datagram set up by setDatagramSizes() for writing
+	///
+	/// @param[in] index The index of the datagram
+	/// @return The datagram data
+	///
+	uint8_t* datagram(int index) { return _datagrams[index].data(); }
+
+	///
+	/// @brief Writes all datagrams set up by setDatagramSizes() in their order, on Linux with a single system call
+	///
+	/// @return Zero on success, else negative
+	///
+	int writeDatagrams();
+
 	///
 	QUdpSocket* _udpSocket;
 	QHostAddress _address;
 	quint16       _port;
 	QString      _defaultHost;
+
+private:
+	///
+	/// @brief Convert the target address into a socket address matching the family of the bound socket
+	///
+	/// @param[in] socket The socket descriptor
+	/// @return True, if the socket address is available
+	///
+	bool updateDestination(qintptr socket);
+
+	/// datagrams of writeDatagrams()
+	std::vector<std::vector<uint8_t>> _datagrams;
+
+	/// destination as socket address for the socket descriptor it was built for
+	QByteArray _destination;
+	qintptr _destinationSocket;
 };
 
 #endif // PROVIDERUDP_H
@@ -3,6 +3,7 @@
 
 // hyperion includes
 #include "ProviderSpi.h"
+#include "SpiClocklessEncoder.h"
 
 ///
 /// Implementation of the LedDevice interface for writing to APA104 led device via spi.
@@ -47,6 +48,7 @@ private:
 	const int SPI_FRAME_END_LATCH_BYTES;
 
 	uint8_t bitpair_to_byte[4];
+	const SpiClocklessEncoder _encoder;
 };
 
 #endif // LEDEVICEAPA104_H
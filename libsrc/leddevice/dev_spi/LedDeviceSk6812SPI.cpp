@@ -10,6 +10,7 @@ LedDeviceSk6812SPI::LedDeviceSk6812SPI(const QJsonObject &deviceConfig)
 		  0b11001000,
 		  0b11001100,
 		  }
+	  , _encoder(bitpair_to_byte)
 {
 }
 
@@ -53,30 +54,17 @@ bool LedDeviceSk6812SPI::init(const QJsonObject &deviceConfig)
 
 int LedDeviceSk6812SPI::write(const std::vector<ColorRgb> &ledValues)
 {
-	unsigned spi_ptr = 0;
 	const int SPI_BYTES_PER_LED = sizeof(ColorRgbw) * SPI_BYTES_PER_COLOUR;
+	const size_t ledCount = qMin(ledValues.size(), static_cast<size_t>(_ledCount));
+	uint8_t* spi_ptr = _ledBuffer.data();
 
-
-	for (const ColorRgb& color : ledValues)
+	// the latch bytes behind the LED data are never written and stay zero
+	for (size_t i = 0; i < ledCount; ++i)
 	{
-		RGBW::Rgb_to_Rgbw(color, &_temp_rgbw, _whiteAlgorithm);
-		uint32_t colorBits = 
-			((uint32_t)_temp_rgbw.red << 24) +
-			((uint32_t)_temp_rgbw.green << 16) +
-			((uint32_t)_temp_rgbw.blue << 8) +
-			_temp_rgbw.white;
-
-		for (int j=SPI_BYTES_PER_LED - 1; j>=0; j--)
-		{
-			_ledBuffer[spi_ptr+j] = bitpair_to_byte[ colorBits & 0x3 ];
-			colorBits >>= 2;
-		}
+		RGBW::Rgb_to_Rgbw(ledValues[i], &_temp_rgbw, _whiteAlgorithm);
+		_encoder.encode(reinterpret_cast<const uint8_t*>(&_temp_rgbw), sizeof(ColorRgbw), spi_ptr);
 		spi_ptr += SPI_BYTES_PER_LED;
 	}
 
-	_ledBuffer[spi_ptr++] = 0;
-	_ledBuffer[spi_ptr++] = 0;
-	_ledBuffer[spi_ptr++] = 0;
-
 	return writeBytes(_ledBuffer.size(), _ledBuffer.data());
 }
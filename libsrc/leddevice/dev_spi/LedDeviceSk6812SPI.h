@@ -3,6 +3,7 @@
 
 // hyperion includes
 #include "ProviderSpi.h"
+#include "SpiClocklessEncoder.h"
 
 ///
 /// Implementation of the LedDevice interface for writing to Sk6801 LED-device via SPI.
@@ -47,6 +48,7 @@ private:
 
 	const int SPI_BYTES_PER_COLOUR;
 	uint8_t bitpair_to_byte[4];
+	const SpiClocklessEncoder _encoder;
 
 	ColorRgbw _temp_rgbw;
 };
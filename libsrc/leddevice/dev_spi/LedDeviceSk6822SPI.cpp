@@ -47,6 +47,7 @@ LedDeviceSk6822SPI::LedDeviceSk6822SPI(const QJsonObject &deviceConfig)
 		  0b11101000,
 		  0b11101110,
 		  }
+	  , _encoder(bitpair_to_byte)
 {
 }
 
@@ -77,20 +78,13 @@ bool LedDeviceSk6822SPI::init(const QJsonObject &deviceConfig)
 
 int LedDeviceSk6822SPI::write(const std::vector<ColorRgb> &ledValues)
 {
-	unsigned spi_ptr = 0;
 	const int SPI_BYTES_PER_LED = sizeof(ColorRgb) * SPI_BYTES_PER_COLOUR;
+	const size_t ledCount = qMin(ledValues.size(), static_cast<size_t>(_ledCount));
+	uint8_t* spi_ptr = _ledBuffer.data();
 
-	for (const ColorRgb& color : ledValues)
+	for (size_t i = 0; i < ledCount; ++i)
 	{
-		uint32_t colorBits = ((unsigned int)color.red << 16)
-							 | ((unsigned int)color.green << 8)
-							 | color.blue;
-
-		for (int j=SPI_BYTES_PER_LED - 1; j>=0; j--)
-		{
-			_ledBuffer[spi_ptr+j] = bitpair_to_byte[ colorBits & 0x3 ];
-			colorBits >>= 2;
-		}
+		_encoder.encode(reinterpret_cast<const uint8_t*>(&ledValues[i]), sizeof(ColorRgb), spi_ptr);
 		spi_ptr += SPI_BYTES_PER_LED;
 		spi_ptr += SPI_BYTES_WAIT_TIME;	// the wait between led time is all zeros
 	}
@@ -44,6 +44,7 @@ LedDeviceWs2812SPI::LedDeviceWs2812SPI(const QJsonObject &deviceConfig)
 		  0b11001000,
 		  0b11001100,
 		  }
+	  , _encoder(bitpair_to_byte)
 {
 }
 
@@ -73,27 +74,9 @@ bool LedDeviceWs2812SPI::init(const QJsonObject &deviceConfig)
 
 int LedDeviceWs2812SPI::write(const std::vector<ColorRgb> &ledValues)
 {
-	unsigned spi_ptr = 0;
-	const int SPI_BYTES_PER_LED = sizeof(ColorRgb) * SPI_BYTES_PER_COLOUR;
-
-	for (const ColorRgb& color : ledValues)
-	{
-		uint32_t colorBits = ((unsigned int)color.red << 16)
-							 | ((unsigned int)color.green << 8)
-							 | color.blue;
-
-		for (int j=SPI_BYTES_PER_LED - 1; j>=0; j--)
-		{
-			_ledBuffer[spi_ptr+j] = bitpair_to_byte[ colorBits & 0x3 ];
-			colorBits >>= 2;
-		}
-		spi_ptr += SPI_BYTES_PER_LED;
-	}
-
-	for (int j=0; j < SPI_FRAME_END_LATCH_BYTES; j++)
-	{
-		_ledBuffer[spi_ptr++] = 0;
-	}
+	// the latch bytes behind the LED data are never written and stay zero
+	const size_t colorBytes = qMin(ledValues.size() * sizeof(ColorRgb), static_cast<size_t>(_ledRGBCount));
+	_encoder.encode(reinterpret_cast<const uint8_t*>(ledValues.data()), colorBytes, _ledBuffer.data());
 
 	return writeBytes(_ledBuffer.size(), _ledBuffer.data());
 }
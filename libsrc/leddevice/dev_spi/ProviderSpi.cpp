@@ -4,6 +4,7 @@
 #include <cstdio>
 #include <iostream>
 #include <cerrno>
+#include <vector>
 
 // Linux includes
 #include <fcntl.h>
@@ -16,6 +17,10 @@
 
 // qt includes
 #include <QDir>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
 
 // Constants
 namespace {
@@ -27,6 +32,123 @@ namespace {
 
 } //End of constants
 
+///
+/// Writes the frames of a ProviderSpi to the spi-device. The frame is copied into the transfer buffer, so the
+/// LedDevice thread encodes the next frame while the SPI_IOC_MESSAGE ioctl of the current one is running.
+///
+class SpiTransferThread : public QThread
+{
+public:
+	SpiTransferThread(int fid, int latchTime_ms, Logger* log)
+		: QThread()
+		, _fid(fid)
+		, _latchTime_ms(latchTime_ms)
+		, _log(log)
+		, _pending(false)
+		, _stop(false)
+		, _lastResult(0)
+	{
+	}
+
+	///
+	/// Waits until the previous frame is sent and queues the given one
+	///
+	/// @return The result of the previous transfer
+	///
+	int submit(unsigned size, const uint8_t* data, bool invert)
+	{
+		QMutexLocker lock(&_mutex);
+		while (_pending)
+		{
+			_condition.wait(&_mutex);
+		}
+
+		_buffer.resize(size);
+		if (invert)
+		{
+			for (unsigned i = 0; i < size; ++i)
+			{
+				_buffer[i] = data[i] ^ 0xff;
+			}
+		}
+		else
+		{
+			memcpy(_buffer.data(), data, size);
+		}
+
+		_pending = true;
+		_condition.wakeAll();
+		return _lastResult;
+	}
+
+	///
+	/// Sends a still queued frame and stops the thread
+	///
+	void stop()
+	{
+		{
+			QMutexLocker lock(&_mutex);
+			_stop = true;
+			_condition.wakeAll();
+		}
+		wait();
+	}
+
+protected:
+	void run() override
+	{
+		QMutexLocker lock(&_mutex);
+		for (;;)
+		{
+			while (!_pending && !_stop)
+			{
+				_condition.wait(&_mutex);
+			}
+			if (!_pending)
+			{
+				break;
+			}
+
+			// the buffer is not touched by submit() while a transfer is pending
+			lock.unlock();
+			spi_ioc_transfer spi;
+			memset(&spi, 0, sizeof(spi));
+			spi.tx_buf = __u64(_buffer.data());
+			spi.len    = __u32(_buffer.size());
+
+			// the latch time counts from the end of the previous transfer, not from its submission
+			const qint64 remainingLatch_ms = _sinceTransfer.isValid() ? _latchTime_ms - _sinceTransfer.elapsed() : 0;
+			if (remainingLatch_ms > 0)
+			{
+				QThread::msleep(static_cast<unsigned long>(remainingLatch_ms));
+			}
+
+			int retVal = ioctl(_fid, SPI_IOC_MESSAGE(1), &spi);
+			ErrorIf((retVal < 0), _log, "SPI failed to write. errno: %d, %s", errno,  strerror(errno) );
+			_sinceTransfer.start();
+			lock.relock();
+
+			_lastResult = retVal < 0 ? retVal : 0;
+			_pending = false;
+			_condition.wakeAll();
+		}
+	}
+
+private:
+	const int _fid;
+	const int _latchTime_ms;
+	Logger* _log;
+	QElapsedTimer _sinceTransfer;
+
+	QMutex _mutex;
+	QWaitCondition _condition;
+	/// the frame being sent
+	std::vector<uint8_t> _buffer;
+	bool _pending;
+	bool _stop;
+	int _lastResult;
+};
+
 ProviderSpi::ProviderSpi(const QJsonObject &deviceConfig)
 	: LedDevice(deviceConfig)
 	, _deviceName("/dev/spidev0.0")
@@ -35,12 +157,15 @@ ProviderSpi::ProviderSpi(const QJsonObject &deviceConfig)
 	, _spiMode(SPI_MODE_0)
 	, _spiDataInvert(false)
 {
-	memset(&_spi, 0, sizeof(_spi));
 	_latchTime_ms = 1;
 }
 
 ProviderSpi::~ProviderSpi()
 {
+	if ( _transferThread )
+	{
+		_transferThread->stop();
+	}
 }
 
 bool ProviderSpi::init(const QJsonObject &deviceConfig)
@@ -99,6 +224,8 @@ int ProviderSpi::open()
 				else
 				{
 					// Everything OK -> enable device
+					_transferThread.reset(new SpiTransferThread(_fid, _latchTime_ms, _log));
+					_transferThread->start(QThread::HighPriority);
 					_isDeviceReady = true;
 					retval = 0;
 				}
@@ -124,6 +251,13 @@ int ProviderSpi::close()
 	int retval = 0;
 	_isDeviceReady = false;
 
+	// Send the pending frame (e.g. black when switching off) before closing
+	if ( _transferThread )
+	{
+		_transferThread->stop();
+		_transferThread.reset();
+	}
+
 	// Test, if device requires closing
 	if ( _fid > -1 )
 	{
@@ -139,27 +273,12 @@ int ProviderSpi::close()
 
 int ProviderSpi::writeBytes(unsigned size, const uint8_t * data)
 {
-	if (_fid < 0)
+	if (_fid < 0 || !_transferThread)
 	{
 		return -1;
 	}
 
-	_spi.tx_buf = __u64(data);
-	_spi.len    = __u32(size);
-
-	if (_spiDataInvert)
-	{
-		uint8_t * newdata = (uint8_t *)malloc(size);
-		for (unsigned i = 0; i<size; i++) {
-			newdata[i] = data[i] ^ 0xff;
-		}
-		_spi.tx_buf = __u64(newdata);
-	}
-
-	int retVal = ioctl(_fid, SPI_IOC_MESSAGE(1), &_spi);
-	ErrorIf((retVal < 0), _log, "SPI failed to write. errno: %d, %s", errno,  strerror(errno) );
-
-	return retVal;
+	return _transferThread->submit(size, data, _spiDataInvert);
 }
 
 QJsonObject ProviderSpi::discover(const QJsonObject& /*params*/)
@@ -1,11 +1,16 @@
 #pragma once
 
+// STL includes
+#include <memory>
+
 // Linux-SPI includes
 #include <linux/spi/spidev.h>
 
 // Hyperion includes
 #include <leddevice/LedDevice.h>
 
+class SpiTransferThread;
+
 ///
 /// The ProviderSpi implements an abstract base-class for LedDevices using the SPI-device.
 ///
@@ -51,13 +56,14 @@ public slots:
 
 protected:
 	///
-	/// Writes the given bytes/bits to the SPI-device and sleeps the latch time to ensure that the
-	/// values are latched.
+	/// Hands the given bytes/bits over to the transfer thread, which writes them to the SPI-device.
+	/// The data is copied, so the caller can encode the next frame while the current one is sent.
+	/// Waits only while the previous frame is still being sent.
 	///
 	/// @param[in[ size The length of the data
 	/// @param[in] data The data
 	///
-	/// @return Zero on success, else negative
+	/// @return Zero on success, else negative (errors of the previous transfer are reported here)
 	///
 	int writeBytes(unsigned size, const uint8_t *data);
 
@@ -76,6 +82,6 @@ protected:
 	/// 1=>invert the data pattern
 	bool _spiDataInvert;
 
-	/// The transfer structure for writing to the spi-device
-	spi_ioc_transfer _spi;
+	/// Sends the frames to the spi-device, runs while the device is open
+	std::unique_ptr<SpiTransferThread> _transferThread;
 };
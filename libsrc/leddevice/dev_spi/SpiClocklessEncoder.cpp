@@ -0,0 +1,60 @@
+#include "SpiClocklessEncoder.h"
+
+// STL includes
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+#endif
+
+SpiClocklessEncoder::SpiClocklessEncoder(const uint8_t (&bitpairToByte)[4])
+{
+	for (int value = 0; value < 256; ++value)
+	{
+		_byteToSpi[value][0] = bitpairToByte[(value >> 6) & 0x3];
+		_byteToSpi[value][1] = bitpairToByte[(value >> 4) & 0x3];
+		_byteToSpi[value][2] = bitpairToByte[(value >> 2) & 0x3];
+		_byteToSpi[value][3] = bitpairToByte[value & 0x3];
+	}
+
+	for (int nibble = 0; nibble < 16; ++nibble)
+	{
+		_nibbleToSpiHigh[nibble] = bitpairToByte[nibble >> 2];
+		_nibbleToSpiLow[nibble] = bitpairToByte[nibble & 0x3];
+	}
+}
+
+void SpiClocklessEncoder::encode(const uint8_t* src, size_t count, uint8_t* dst) const
+{
+	size_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	uint8x8x2_t high;
+	high.val[0] = vld1_u8(_nibbleToSpiHigh);
+	high.val[1] = vld1_u8(_nibbleToSpiHigh + 8);
+	uint8x8x2_t low;
+	low.val[0] = vld1_u8(_nibbleToSpiLow);
+	low.val[1] = vld1_u8(_nibbleToSpiLow + 8);
+	const uint8x8_t nibbleMask = vdup_n_u8(0x0f);
+
+	// 8 color bytes per step: look up both bit pairs of both nibbles and interleave them to 32 SPI bytes
+	for (; i + 8 <= count; i += 8)
+	{
+		const uint8x8_t value = vld1_u8(src + i);
+		const uint8x8_t upperNibble = vshr_n_u8(value, 4);
+		const uint8x8_t lowerNibble = vand_u8(value, nibbleMask);
+
+		uint8x8x4_t spi;
+		spi.val[0] = vtbl2_u8(high, upperNibble);
+		spi.val[1] = vtbl2_u8(low, upperNibble);
+		spi.val[2] = vtbl2_u8(high, lowerNibble);
+		spi.val[3] = vtbl2_u8(low, lowerNibble);
+		vst4_u8(dst + 4 * i, spi);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		memcpy(dst + 4 * i, _byteToSpi[src[i]], 4);
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef SPICLOCKLESSENCODER_H
+#define SPICLOCKLESSENCODER_H
+
+// STL includes
+#include <cstdint>
+#include <cstddef>
+
+///
+/// Encodes color bytes for clockless LEDs (WS2812, SK6812, ...) driven by SPI. Every color bit becomes a 4 bit
+/// SPI pattern, so every color byte becomes 4 SPI bytes, each holding the patterns of one bit pair.
+/// The 4 SPI bytes of all 256 color bytes are precomputed, on ARM with NEON 8 color bytes are encoded at once.
+///
+class SpiClocklessEncoder
+{
+public:
+	///
+	/// @brief Constructs the encoder
+	///
+	/// @param[in] bitpairToByte The SPI byte for the bit pairs 00, 01, 10 and 11
+	///
+	explicit SpiClocklessEncoder(const uint8_t (&bitpairToByte)[4]);
+
+	///
+	/// @brief Encodes the given color bytes
+	///
+	/// @param[in] src The color bytes
+	/// @param[in] count The number of color bytes
+	/// @param[out] dst The SPI bytes, 4 * count bytes are written
+	///
+	void encode(const uint8_t* src, size_t count, uint8_t* dst) const;
+
+private:
+	/// SPI bytes per color byte, in transmission order
+	uint8_t _byteToSpi[256][4];
+
+	/// SPI bytes of the upper and lower bit pair of every nibble, used by the NEON encoder
+	uint8_t _nibbleToSpiHigh[16];
+	uint8_t _nibbleToSpiLow[16];
+};
+
+#endif // SPICLOCKLESSENCODER_H
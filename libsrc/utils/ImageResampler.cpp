@@ -2,6 +2,111 @@
 #include <utils/ColorSys.h>
 #include <utils/Logger.h>
 
+// STL includes
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define IMAGERESAMPLER_NEON
+#endif
+
+namespace {
+
+///
+/// Converts a row of y/u/v samples into rgb. Uses the same integer math as ColorSys::yuv2rgb,
+/// eight pixels at a time where SSE2 or NEON is available.
+///
+void yuvRowToRgb(const uint8_t * y, const uint8_t * u, const uint8_t * v, int count, ColorRgb * rgb)
+{
+	int x = 0;
+
+#if defined(__SSE2__)
+	const __m128i zero    = _mm_setzero_si128();
+	const __m128i one     = _mm_set1_epi16(1);
+	const __m128i off16   = _mm_set1_epi16(16);
+	const __m128i off128  = _mm_set1_epi16(128);
+	const __m128i round   = _mm_set1_epi32(128);
+	// coefficients for (c,e), (c,d) and (e,1) pairs of _mm_madd_epi16
+	const __m128i coefR   = _mm_set_epi16(409, 298, 409, 298, 409, 298, 409, 298);
+	const __m128i coefGcd = _mm_set_epi16(-100, 298, -100, 298, -100, 298, -100, 298);
+	const __m128i coefGe  = _mm_set_epi16(128, -208, 128, -208, 128, -208, 128, -208);
+	const __m128i coefB   = _mm_set_epi16(516, 298, 516, 298, 516, 298, 516, 298);
+
+	alignas(16) uint8_t r[16], g[16], b[16];
+	for (; x + 8 <= count; x += 8)
+	{
+		const __m128i c = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero), off16);
+		const __m128i d = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x)), zero), off128);
+		const __m128i e = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x)), zero), off128);
+
+		const __m128i ceLo = _mm_unpacklo_epi16(c, e);
+		const __m128i ceHi = _mm_unpackhi_epi16(c, e);
+		const __m128i cdLo = _mm_unpacklo_epi16(c, d);
+		const __m128i cdHi = _mm_unpackhi_epi16(c, d);
+		const __m128i e1Lo = _mm_unpacklo_epi16(e, one);
+		const __m128i e1Hi = _mm_unpackhi_epi16(e, one);
+
+		const __m128i rLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, coefR), round), 8);
+		const __m128i rHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, coefR), round), 8);
+		const __m128i gLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, coefGcd), _mm_madd_epi16(e1Lo, coefGe)), 8);
+		const __m128i gHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, coefGcd), _mm_madd_epi16(e1Hi, coefGe)), 8);
+		const __m128i bLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, coefB), round), 8);
+		const __m128i bHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, coefB), round), 8);
+
+		// saturating packs clamp to [0,255]
+		const __m128i r16 = _mm_packs_epi32(rLo, rHi);
+		const __m128i g16 = _mm_packs_epi32(gLo, gHi);
+		const __m128i b16 = _mm_packs_epi32(bLo, bHi);
+		_mm_store_si128(reinterpret_cast<__m128i*>(r), _mm_packus_epi16(r16, r16));
+		_mm_store_si128(reinterpret_cast<__m128i*>(g), _mm_packus_epi16(g16, g16));
+		_mm_store_si128(reinterpret_cast<__m128i*>(b), _mm_packus_epi16(b16, b16));
+
+		for (int i = 0; i < 8; ++i)
+		{
+			rgb[x + i] = ColorRgb{r[i], g[i], b[i]};
+		}
+	}
+#elif defined(IMAGERESAMPLER_NEON)
+	const int16x8_t off16  = vdupq_n_s16(16);
+	const int16x8_t off128 = vdupq_n_s16(128);
+	const int32x4_t round  = vdupq_n_s32(128);
+
+	for (; x + 8 <= count; x += 8)
+	{
+		const int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + x))), off16);
+		const int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + x))), off128);
+		const int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + x))), off128);
+
+		const int32x4_t cLo = vmlal_n_s16(round, vget_low_s16(c), 298);
+		const int32x4_t cHi = vmlal_n_s16(round, vget_high_s16(c), 298);
+
+		const int32x4_t rLo = vmlal_n_s16(cLo, vget_low_s16(e), 409);
+		const int32x4_t rHi = vmlal_n_s16(cHi, vget_high_s16(e), 409);
+		const int32x4_t gLo = vmlal_n_s16(vmlal_n_s16(cLo, vget_low_s16(d), -100), vget_low_s16(e), -208);
+		const int32x4_t gHi = vmlal_n_s16(vmlal_n_s16(cHi, vget_high_s16(d), -100), vget_high_s16(e), -208);
+		const int32x4_t bLo = vmlal_n_s16(cLo, vget_low_s16(d), 516);
+		const int32x4_t bHi = vmlal_n_s16(cHi, vget_high_s16(d), 516);
+
+		// saturating narrows clamp to [0,255], vst3 interleaves into rgb triplets
+		uint8x8x3_t out;
+		out.val[0] = vqmovun_s16(vcombine_s16(vshrn_n_s32(rLo, 8), vshrn_n_s32(rHi, 8)));
+		out.val[1] = vqmovun_s16(vcombine_s16(vshrn_n_s32(gLo, 8), vshrn_n_s32(gHi, 8)));
+		out.val[2] = vqmovun_s16(vcombine_s16(vshrn_n_s32(bLo, 8), vshrn_n_s32(bHi, 8)));
+		vst3_u8(reinterpret_cast<uint8_t*>(rgb + x), out);
+	}
+#endif
+
+	for (; x < count; ++x)
+	{
+		ColorSys::yuv2rgb(y[x], u[x], v[x], rgb[x].red, rgb[x].green, rgb[x].blue);
+	}
+}
+
+} // namespace
+
 ImageResampler::ImageResampler()
 	: _horizontalDecimation(8)
 	, _verticalDecimation(8)
@@ -26,8 +131,6 @@ void ImageResampler::processImage(const uint8_t * data, int width, int height, i
 {
 	int cropRight  = _cropRight;
 	int cropBottom = _cropBottom;
-	int xDestFlip = 0, yDestFlip = 0;
-	int uOffset = 0, vOffset = 0;
 
 	// handle 3D mode
 	switch (_videoMode)
@@ -48,122 +151,134 @@ void ImageResampler::processImage(const uint8_t * data, int width, int height, i
 
 	outputImage.resize(outputWidth, outputHeight);
 
+	if (outputWidth <= 0 || outputHeight <= 0)
+	{
+		return;
+	}
+
+	// resolve flipping once, rows are mirrored by the destination row, columns by reversing the finished row
+	const bool flipRows    = (_flipMode == FlipMode::HORIZONTAL || _flipMode == FlipMode::BOTH);
+	const bool flipColumns = (_flipMode == FlipMode::VERTICAL   || _flipMode == FlipMode::BOTH);
+
+	// byte offsets of the y/u/v samples inside a packed 4:2:2 macro pixel
+	int yPacked = 0, uPacked = 1, vPacked = 3;
+	if (pixelFormat == PixelFormat::UYVY)
+	{
+		yPacked = 1; uPacked = 0; vPacked = 2;
+	}
+
+	// sample rows for the yuv formats, converted to rgb in one go per row
+	std::vector<uint8_t> yuvRow;
+	if (pixelFormat == PixelFormat::YUYV || pixelFormat == PixelFormat::UYVY || pixelFormat == PixelFormat::NV12 || pixelFormat == PixelFormat::I420)
+	{
+		yuvRow.resize(3 * size_t(outputWidth));
+	}
+	uint8_t * yRow = yuvRow.data();
+	uint8_t * uRow = yRow + outputWidth;
+	uint8_t * vRow = uRow + outputWidth;
+
+	const int xStart = _cropLeft + (_horizontalDecimation >> 1);
+	const int xStep  = _horizontalDecimation;
+
 	for (int yDest = 0, ySource = _cropTop + (_verticalDecimation >> 1); yDest < outputHeight; ySource += _verticalDecimation, ++yDest)
 	{
-		int yOffset = lineLength * ySource;
-		if (pixelFormat == PixelFormat::NV12)
-		{
-			uOffset = (height + ySource / 2) * lineLength;
-		}
-		else if (pixelFormat == PixelFormat::I420)
-		{
-			uOffset = (lineLength * (5 * height + ySource) / 4);
-			vOffset = (lineLength * (4 * height + ySource)) * 4;
-		}
+		ColorRgb * destRow = outputImage.memptr() + size_t(flipRows ? outputHeight - yDest - 1 : yDest) * outputWidth;
+		const uint8_t * line = data + size_t(lineLength) * ySource;
 
-		for (int xDest = 0, xSource = _cropLeft + (_horizontalDecimation >> 1); xDest < outputWidth; xSource += _horizontalDecimation, ++xDest)
+		switch (pixelFormat)
 		{
-			switch (_flipMode)
-			{
-				case FlipMode::HORIZONTAL:
-
-					xDestFlip = xDest;
-					yDestFlip = outputHeight-yDest-1;
-					break;
-				case FlipMode::VERTICAL:
-					xDestFlip = outputWidth-xDest-1;
-					yDestFlip = yDest;
-					break;
-				case FlipMode::BOTH:
-					xDestFlip = outputWidth-xDest-1;
-					yDestFlip = outputHeight-yDest-1;
-					break;
-				case FlipMode::NO_CHANGE:
-					xDestFlip = xDest;
-					yDestFlip = yDest;
-					break;
-			}
-
-			ColorRgb &rgb = outputImage(xDestFlip, yDestFlip);
-			switch (pixelFormat)
+			case PixelFormat::UYVY:
+			case PixelFormat::YUYV:
 			{
-				case PixelFormat::UYVY:
-				{
-					int index = yOffset + (xSource << 1);
-					uint8_t y = data[index+1];
-					uint8_t u = ((xSource&1) == 0) ? data[index  ] : data[index-2];
-					uint8_t v = ((xSource&1) == 0) ? data[index+2] : data[index  ];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
-				}
-				break;
-				case PixelFormat::YUYV:
+				for (int xDest = 0, xSource = xStart; xDest < outputWidth; xSource += xStep, ++xDest)
 				{
-					int index = yOffset + (xSource << 1);
-					uint8_t y = data[index];
-					uint8_t u = ((xSource&1) == 0) ? data[index+1] : data[index-1];
-					uint8_t v = ((xSource&1) == 0) ? data[index+3] : data[index+1];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
+					const uint8_t * pair = line + ((xSource >> 1) << 2);
+					yRow[xDest] = pair[yPacked + ((xSource & 1) << 1)];
+					uRow[xDest] = pair[uPacked];
+					vRow[xDest] = pair[vPacked];
 				}
-				break;
-				case PixelFormat::BGR16:
+				yuvRowToRgb(yRow, uRow, vRow, outputWidth, destRow);
+			}
+			break;
+			case PixelFormat::BGR16:
+			{
+				for (int xDest = 0, xSource = xStart; xDest < outputWidth; xSource += xStep, ++xDest)
 				{
-					int index = yOffset + (xSource << 1);
-					rgb.blue  = (data[index] & 0x1f) << 3;
-					rgb.green = (((data[index+1] & 0x7) << 3) | (data[index] & 0xE0) >> 5) << 2;
-					rgb.red   = (data[index+1] & 0xF8);
+					const uint8_t * pixel = line + (xSource << 1);
+					ColorRgb & rgb = destRow[xDest];
+					rgb.blue  = (pixel[0] & 0x1f) << 3;
+					rgb.green = (((pixel[1] & 0x7) << 3) | (pixel[0] & 0xE0) >> 5) << 2;
+					rgb.red   = (pixel[1] & 0xF8);
 				}
-				break;
-				case PixelFormat::BGR24:
+			}
+			break;
+			case PixelFormat::BGR24:
+			{
+				for (int xDest = 0, xSource = xStart; xDest < outputWidth; xSource += xStep, ++xDest)
 				{
-					int index = yOffset + (xSource << 1) + xSource;
-					rgb.blue  = data[index  ];
-					rgb.green = data[index+1];
-					rgb.red   = data[index+2];
+					const uint8_t * pixel = line + (xSource << 1) + xSource;
+					destRow[xDest] = ColorRgb{pixel[2], pixel[1], pixel[0]};
 				}
-				break;
-				case PixelFormat::RGB32:
+			}
+			break;
+			case PixelFormat::RGB32:
+			{
+				for (int xDest = 0, xSource = xStart; xDest < outputWidth; xSource += xStep, ++xDest)
 				{
-					int index = yOffset + (xSource << 2);
-					rgb.red   = data[index  ];
-					rgb.green = data[index+1];
-					rgb.blue  = data[index+2];
+					const uint8_t * pixel = line + (xSource << 2);
+					destRow[xDest] = ColorRgb{pixel[0], pixel[1], pixel[2]};
 				}
-				break;
-				case PixelFormat::BGR32:
+			}
+			break;
+			case PixelFormat::BGR32:
+			{
+				for (int xDest = 0, xSource = xStart; xDest < outputWidth; xSource += xStep, ++xDest)
 				{
-					int index = yOffset + (xSource << 2);
-					rgb.blue  = data[index  ];
-					rgb.green = data[index+1];
-					rgb.red   = data[index+2];
+					const uint8_t * pixel = line + (xSource << 2);
+					destRow[xDest] = ColorRgb{pixel[2], pixel[1], pixel[0]};
 				}
-				break;
-				case PixelFormat::NV12:
+			}
+			break;
+			case PixelFormat::NV12:
+			{
+				// interleaved u/v plane with half vertical resolution
+				const uint8_t * uvLine = data + size_t(lineLength) * (height + ySource / 2);
+				for (int xDest = 0, xSource = xStart; xDest < outputWidth; xSource += xStep, ++xDest)
 				{
-					int index = yOffset + xSource;
-					uint8_t y = data[index];
-					uint8_t u = data[uOffset + ((xSource >> 1) << 1)];
-					uint8_t v = data[uOffset + ((xSource >> 1) << 1) + 1];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
+					yRow[xDest] = line[xSource];
+					uRow[xDest] = uvLine[(xSource >> 1) << 1];
+					vRow[xDest] = uvLine[((xSource >> 1) << 1) + 1];
 				}
-				break;
-				case PixelFormat::I420:
+				yuvRowToRgb(yRow, uRow, vRow, outputWidth, destRow);
+			}
+			break;
+			case PixelFormat::I420:
+			{
+				// separate u and v planes with half horizontal and vertical resolution
+				const int chromaLineLength = lineLength / 2;
+				const uint8_t * uLine = data + size_t(lineLength) * height + size_t(chromaLineLength) * (ySource / 2);
+				const uint8_t * vLine = uLine + size_t(chromaLineLength) * (height / 2);
+				for (int xDest = 0, xSource = xStart; xDest < outputWidth; xSource += xStep, ++xDest)
 				{
-					int index = yOffset + xSource;
-					uint8_t y = data[index];
-					uint8_t u = data[uOffset + xSource];
-					uint8_t v = data[vOffset + xSource];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
-					break;
+					yRow[xDest] = line[xSource];
+					uRow[xDest] = uLine[xSource >> 1];
+					vRow[xDest] = vLine[xSource >> 1];
 				}
-				break;
+				yuvRowToRgb(yRow, uRow, vRow, outputWidth, destRow);
+			}
+			break;
 #ifdef HAVE_TURBO_JPEG
-				case PixelFormat::MJPEG:
-				break;
+			case PixelFormat::MJPEG:
+			break;
 #endif
-				case PixelFormat::NO_CHANGE:
-					Error(Logger::getInstance("ImageResampler"), "Invalid pixel format given");
-				break;
-			}
+			case PixelFormat::NO_CHANGE:
+				Error(Logger::getInstance("ImageResampler"), "Invalid pixel format given");
+				return;
+		}
+
+		if (flipColumns)
+		{
+			std::reverse(destRow, destRow + outputWidth);
 		}
 	}
 }
@@ -8,6 +8,43 @@
 #include <QRegularExpression>
 #include <QJsonObject>
 #include <QJsonParseError>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+// stl includes
+#include <memory>
+
+namespace {
+	/// Parsed json files from the Qt resources, shared by all threads
+	QHash<QString, QJsonObject> resourceCache;
+	QMutex resourceCacheMutex;
+
+	/// A configured checker of a schema from the Qt resources, it keeps state while validating
+	struct CachedSchemaChecker
+	{
+		QMutex mutex;
+		QJsonSchemaChecker checker;
+	};
+
+	/// Checkers by schema path, shared by all threads
+	QHash<QString, std::shared_ptr<CachedSchemaChecker>> checkerCache;
+	QMutex checkerCacheMutex;
+
+	bool validateWith(QJsonSchemaChecker& schemaChecker, const QString& file, const QJsonObject& json, Logger* log)
+	{
+		if (!schemaChecker.validate(json).first)
+		{
+			const QStringList & errors = schemaChecker.getMessages();
+			for (auto & error : errors)
+			{
+				Error(log, "While validating schema against json data of '%s':%s", QSTRING_CSTR(file), QSTRING_CSTR(error));
+			}
+			return false;
+		}
+		return true;
+	}
+}
 
 namespace JsonUtils {
 
@@ -23,6 +60,31 @@ namespace JsonUtils {
 		return true;
 	}
 
+	bool readCachedFile(const QString& path, QJsonObject& obj, Logger* log)
+	{
+		// files on disk may change, read them each time
+		if (!path.startsWith(':'))
+			return readFile(path, obj, log);
+
+		{
+			QMutexLocker lock(&resourceCacheMutex);
+			auto it = resourceCache.constFind(path);
+			if (it != resourceCache.constEnd())
+			{
+				obj = it.value();
+				return true;
+			}
+		}
+
+		// parse outside of the lock, a concurrent first read just parses twice
+		if(!readFile(path, obj, log))
+			return false;
+
+		QMutexLocker lock(&resourceCacheMutex);
+		resourceCache.insert(path, obj);
+		return true;
+	}
+
 	bool readSchema(const QString& path, QJsonObject& obj, Logger* log)
 	{
 		QJsonObject schema;
@@ -86,31 +148,51 @@ namespace JsonUtils {
 
 	bool validate(const QString& file, const QJsonObject& json, const QString& schemaPath, Logger* log)
 	{
-		// get the schema data
-		QJsonObject schema;
-		if(!readFile(schemaPath, schema, log))
-			return false;
+		// schema files on disk may change, read them each time
+		if (!schemaPath.startsWith(':'))
+		{
+			QJsonObject schema;
+			if(!readFile(schemaPath, schema, log))
+				return false;
 
-		if(!validate(file, json, schema, log))
-			return false;
-		return true;
+			return validate(file, json, schema, log);
+		}
 
+		std::shared_ptr<CachedSchemaChecker> cached;
+		{
+			QMutexLocker lock(&checkerCacheMutex);
+			cached = checkerCache.value(schemaPath);
+		}
+
+		if (!cached)
+		{
+			// get the schema data
+			QJsonObject schema;
+			if(!readCachedFile(schemaPath, schema, log))
+				return false;
+
+			std::shared_ptr<CachedSchemaChecker> created = std::make_shared<CachedSchemaChecker>();
+			created->checker.setSchema(schema);
+
+			// a concurrent first validation keeps the checker inserted first
+			QMutexLocker lock(&checkerCacheMutex);
+			cached = checkerCache.value(schemaPath);
+			if (!cached)
+			{
+				checkerCache.insert(schemaPath, created);
+				cached = created;
+			}
+		}
+
+		QMutexLocker lock(&cached->mutex);
+		return validateWith(cached->checker, file, json, log);
 	}
 
 	bool validate(const QString& file, const QJsonObject& json, const QJsonObject& schema, Logger* log)
 	{
 		QJsonSchemaChecker schemaChecker;
 		schemaChecker.setSchema(schema);
-		if (!schemaChecker.validate(json).first)
-		{
-			const QStringList & errors = schemaChecker.getMessages();
-			for (auto & error : errors)
-			{
-				Error(log, "While validating schema against json data of '%s':%s", QSTRING_CSTR(file), QSTRING_CSTR(error));
-			}
-			return false;
-		}
-		return true;
+		return validateWith(schemaChecker, file, json, log);
 	}
 
 	bool write(const QString& filename, const QJsonObject& json, Logger* log)
@@ -0,0 +1,213 @@
+#include <utils/LatencyTracer.h>
+
+// STL includes
+#include <atomic>
+#include <chrono>
+
+// Qt includes
+#include <QStringBuilder>
+
+namespace {
+
+/// values below are stored 1:1, above with 8 sub-buckets per power of two
+const int LINEAR_BUCKETS = 16;
+const int SUB_BUCKETS = 8;
+const int MAX_EXPONENT = 40;
+const int BUCKET_COUNT = LINEAR_BUCKETS + (MAX_EXPONENT - 3) * SUB_BUCKETS;
+
+struct Histogram
+{
+	std::atomic<uint32_t> buckets[BUCKET_COUNT];
+	std::atomic<uint64_t> sum;
+	std::atomic<uint64_t> max;
+};
+
+Histogram histograms[LatencyTracer::STAGE_COUNT];
+
+const char* const STAGE_NAMES[LatencyTracer::STAGE_COUNT] =
+{
+	"capture_to_muxer",
+	"hyperion_update",
+	"image_process",
+	"smoothing",
+	"device_queue",
+	"device_write",
+	"end_to_end"
+};
+
+int bucketIndex(uint64_t value)
+{
+	if (value < LINEAR_BUCKETS)
+	{
+		return static_cast<int>(value);
+	}
+
+	int exponent = 63;
+	while ((value >> exponent) == 0)
+	{
+		--exponent;
+	}
+	if (exponent > MAX_EXPONENT)
+	{
+		return BUCKET_COUNT - 1;
+	}
+
+	const int sub = static_cast<int>((value >> (exponent - 3)) & (SUB_BUCKETS - 1));
+	return LINEAR_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+}
+
+/// upper bound (inclusive) of the values stored in the bucket
+uint64_t bucketUpperBound(int index)
+{
+	if (index < LINEAR_BUCKETS)
+	{
+		return static_cast<uint64_t>(index);
+	}
+
+	const int exponent = (index - LINEAR_BUCKETS) / SUB_BUCKETS + 4;
+	const uint64_t sub = static_cast<uint64_t>((index - LINEAR_BUCKETS) % SUB_BUCKETS);
+	return ((SUB_BUCKETS + sub + 1) << (exponent - 3)) - 1;
+}
+
+struct Snapshot
+{
+	uint64_t count;
+	uint64_t sum;
+	uint64_t max;
+	uint64_t p50, p95, p99;
+};
+
+Snapshot takeSnapshot(const Histogram& histogram)
+{
+	uint32_t buckets[BUCKET_COUNT];
+	uint64_t total = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+		total += buckets[i];
+	}
+
+	Snapshot snapshot {};
+	snapshot.count = total;
+	snapshot.sum = histogram.sum.load(std::memory_order_relaxed);
+	snapshot.max = histogram.max.load(std::memory_order_relaxed);
+
+	if (total == 0)
+	{
+		return snapshot;
+	}
+
+	const uint64_t rank50 = (total * 50 + 99) / 100;
+	const uint64_t rank95 = (total * 95 + 99) / 100;
+	const uint64_t rank99 = (total * 99 + 99) / 100;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		if (buckets[i] == 0)
+		{
+			continue;
+		}
+		const uint64_t lower = seen;
+		seen += buckets[i];
+		// the max is more precise than the bucket bound for the highest bucket
+		const uint64_t value = qMin(bucketUpperBound(i), snapshot.max);
+		if (lower < rank50 && seen >= rank50) snapshot.p50 = value;
+		if (lower < rank95 && seen >= rank95) snapshot.p95 = value;
+		if (lower < rank99 && seen >= rank99) snapshot.p99 = value;
+	}
+
+	return snapshot;
+}
+
+}
+
+qint64 LatencyTracer::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyTracer::record(Stage stage, qint64 duration_us)
+{
+	if (stage < 0 || stage >= STAGE_COUNT || duration_us < 0)
+	{
+		return;
+	}
+
+	Histogram& histogram = histograms[stage];
+	const uint64_t value = static_cast<uint64_t>(duration_us);
+
+	histogram.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	histogram.sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t max = histogram.max.load(std::memory_order_relaxed);
+	while (value > max && !histogram.max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+void LatencyTracer::recordSince(Stage stage, qint64 start_us)
+{
+	if (start_us > 0)
+	{
+		record(stage, now() - start_us);
+	}
+}
+
+void LatencyTracer::reset()
+{
+	for (Histogram& histogram : histograms)
+	{
+		for (auto& bucket : histogram.buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		histogram.sum.store(0, std::memory_order_relaxed);
+		histogram.max.store(0, std::memory_order_relaxed);
+	}
+}
+
+QJsonObject LatencyTracer::getStatistics()
+{
+	QJsonObject stages;
+	for (int stage = 0; stage < STAGE_COUNT; ++stage)
+	{
+		const Snapshot snapshot = takeSnapshot(histograms[stage]);
+
+		QJsonObject item;
+		item["count"] = static_cast<double>(snapshot.count);
+		item["mean_us"] = snapshot.count > 0 ? static_cast<double>(snapshot.sum / snapshot.count) : 0.0;
+		item["p50_us"] = static_cast<double>(snapshot.p50);
+		item["p95_us"] = static_cast<double>(snapshot.p95);
+		item["p99_us"] = static_cast<double>(snapshot.p99);
+		item["max_us"] = static_cast<double>(snapshot.max);
+		stages[STAGE_NAMES[stage]] = item;
+	}
+	return stages;
+}
+
+QString LatencyTracer::getPrometheusText()
+{
+	QString text;
+	text += QStringLiteral("# HELP hyperion_pipeline_latency_seconds Latency of the frame pipeline stages\n");
+	text += QStringLiteral("# TYPE hyperion_pipeline_latency_seconds summary\n");
+
+	for (int stage = 0; stage < STAGE_COUNT; ++stage)
+	{
+		const Snapshot snapshot = takeSnapshot(histograms[stage]);
+		const QString label = QString("stage=\"%1\"").arg(STAGE_NAMES[stage]);
+
+		text += "hyperion_pipeline_latency_seconds{" % label % ",quantile=\"0.5\"} " % QString::number(snapshot.p50 / 1e6, 'g', 9) % "\n";
+		text += "hyperion_pipeline_latency_seconds{" % label % ",quantile=\"0.95\"} " % QString::number(snapshot.p95 / 1e6, 'g', 9) % "\n";
+		text += "hyperion_pipeline_latency_seconds{" % label % ",quantile=\"0.99\"} " % QString::number(snapshot.p99 / 1e6, 'g', 9) % "\n";
+		text += "hyperion_pipeline_latency_seconds_sum{" % label % "} " % QString::number(snapshot.sum / 1e6, 'g', 12) % "\n";
+		text += "hyperion_pipeline_latency_seconds_count{" % label % "} " % QString::number(snapshot.count) % "\n";
+	}
+
+	return text;
+}
+
+const char* LatencyTracer::stageToString(Stage stage)
+{
+	return (stage >= 0 && stage < STAGE_COUNT) ? STAGE_NAMES[stage] : "unknown";
+}
@@ -1,87 +1,242 @@
 #include "HyperionConfig.h"
 #include <utils/Profiler.h>
-#include <utils/FileUtils.h>
+#include <utils/LatencyTracer.h>
 
-#include <QFileInfo>
-#include <QString>
+#include <atomic>
+#include <memory>
+#include <vector>
 
-struct StopWatchItem {
-	const char* sourceFile;
-	const char* func;
-	unsigned int line;
-	clock_t startTime;
+#include <QJsonArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+namespace {
+
+/// events kept per thread, older events are overwritten
+const quint64 RING_CAPACITY = 8192;
+/// rings of finished threads kept for the next export
+const size_t MAX_FINISHED_RINGS = 16;
+
+struct TraceEvent
+{
+	const char* name;
+	qint64 start;
+	qint64 duration;
 };
 
-static unsigned int blockCounter = 0;
-static std::map<QString,StopWatchItem> GlobalProfilerMap;
-Logger* Profiler::_logger = nullptr;
+struct Ring
+{
+	TraceEvent events[RING_CAPACITY];
+	/// written by the owning thread only
+	std::atomic<quint64> writeIndex;
+	/// events before this index are dropped by clear()
+	std::atomic<quint64> clearIndex;
+	std::atomic<bool> finished;
+	int tid;
+	QString threadName;
+};
+
+#ifdef ENABLE_PROFILER
+std::atomic<bool> tracingEnabled(true);
+#else
+std::atomic<bool> tracingEnabled(false);
+#endif
+
+QMutex registryMutex;
+std::vector<std::shared_ptr<Ring>> registry;
+int nextTid = 1;
+
+struct ThreadRing
+{
+	std::shared_ptr<Ring> ring;
+	std::vector<std::pair<const char*, qint64>> timers;
+
+	~ThreadRing()
+	{
+		if (ring)
+		{
+			ring->finished.store(true, std::memory_order_relaxed);
+		}
+	}
+};
+
+thread_local ThreadRing threadRing;
+
+Ring* currentRing()
+{
+	if (!threadRing.ring)
+	{
+		std::shared_ptr<Ring> ring = std::make_shared<Ring>();
+		ring->writeIndex.store(0, std::memory_order_relaxed);
+		ring->clearIndex.store(0, std::memory_order_relaxed);
+		ring->finished.store(false, std::memory_order_relaxed);
+
+		QThread* thread = QThread::currentThread();
+		ring->threadName = (thread != nullptr) ? thread->objectName() : QString();
+
+		QMutexLocker lock(&registryMutex);
+		ring->tid = nextTid++;
+		if (ring->threadName.isEmpty())
+		{
+			ring->threadName = QString("thread-%1").arg(ring->tid);
+		}
+
+		// forget the oldest finished threads
+		size_t finished = 0;
+		for (const auto& entry : registry)
+		{
+			finished += entry->finished.load(std::memory_order_relaxed) ? 1 : 0;
+		}
+		for (auto it = registry.begin(); it != registry.end() && finished > MAX_FINISHED_RINGS; )
+		{
+			if ((*it)->finished.load(std::memory_order_relaxed))
+			{
+				it = registry.erase(it);
+				--finished;
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		registry.push_back(ring);
+		threadRing.ring = ring;
+	}
+	return threadRing.ring.get();
+}
+
+}
 
-double getClockDelta(clock_t start)
+Profiler::Scope::Scope(const char* name)
+	: _name(name)
+	, _start(tracingEnabled.load(std::memory_order_relaxed) ? LatencyTracer::now() : 0)
 {
-	return ((double)(clock() - start) / CLOCKS_PER_SEC);
 }
 
-Profiler::Profiler(const char* sourceFile, const char* func, unsigned int line)
-	: _file(sourceFile)
-	, _func(func)
-	, _line(line)
-	, _blockId(blockCounter++)
-	, _startTime(clock())
+Profiler::Scope::~Scope()
 {
-	Profiler::initLogger();
-	_logger->Message(Logger::DEBUG,_file,_func,_line,">>> enter block %d", _blockId);
+	if (_start != 0)
+	{
+		Profiler::addEvent(_name, _start, LatencyTracer::now() - _start);
+	}
 }
 
-Profiler::~Profiler()
+void Profiler::setEnabled(bool enable)
 {
-  	_logger->Message( Logger::DEBUG, _file,_func, _line, "<<< exit block %d, executed for %f s", _blockId, getClockDelta(_startTime));
+	tracingEnabled.store(enable, std::memory_order_relaxed);
 }
 
-void Profiler::initLogger()
+bool Profiler::isEnabled()
 {
-	if (_logger == nullptr)
-		_logger = Logger::getInstance("PROFILER", Logger::DEBUG);
+	return tracingEnabled.load(std::memory_order_relaxed);
 }
 
-void Profiler::TimerStart(const QString& timerName, const char* sourceFile, const char* func, unsigned int line)
+void Profiler::addEvent(const char* name, qint64 start_us, qint64 dur_us)
 {
-	std::pair<std::map<QString,StopWatchItem>::iterator,bool> ret;
-	Profiler::initLogger();
+	if (!tracingEnabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	Ring* ring = currentRing();
+	const quint64 index = ring->writeIndex.load(std::memory_order_relaxed);
+	ring->events[index % RING_CAPACITY] = { name, start_us, dur_us };
+	// publish the event for getChromeTrace()
+	ring->writeIndex.store(index + 1, std::memory_order_release);
+}
 
-	StopWatchItem item = {sourceFile, func, line};
+void Profiler::TimerStart(const char* stopWatchName)
+{
+	if (!tracingEnabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
 
-	ret = GlobalProfilerMap.emplace(timerName, item);
-	if (!ret.second)
+	const qint64 now = LatencyTracer::now();
+	for (auto& timer : threadRing.timers)
 	{
-		if (ret.first->second.sourceFile == sourceFile && ret.first->second.func == func && ret.first->second.line == line)
+		if (qstrcmp(timer.first, stopWatchName) == 0)
 		{
-			_logger->Message(Logger::DEBUG, sourceFile, func, line, "restart timer '%s'", QSTRING_CSTR(timerName));
-			ret.first->second.startTime = clock();
+			timer.second = now;
+			return;
 		}
-		else
+	}
+	threadRing.timers.emplace_back(stopWatchName, now);
+}
+
+void Profiler::TimerGetTime(const char* stopWatchName)
+{
+	for (const auto& timer : threadRing.timers)
+	{
+		if (qstrcmp(timer.first, stopWatchName) == 0)
 		{
-			_logger->Message(Logger::DEBUG, sourceFile, func, line, "ERROR timer '%s' started in multiple locations. First occurence %s:%d:%s()",
-			                 QSTRING_CSTR(timerName), FileUtils::getBaseName(ret.first->second.sourceFile).toLocal8Bit().constData(), ret.first->second.line, ret.first->second.func);
+			addEvent(timer.first, timer.second, LatencyTracer::now() - timer.second);
+			return;
 		}
 	}
-	else
+}
+
+void Profiler::clear()
+{
+	QMutexLocker lock(&registryMutex);
+	for (const auto& ring : registry)
 	{
-		_logger->Message(Logger::DEBUG, sourceFile, func, line, "start timer '%s'", QSTRING_CSTR(timerName));
+		ring->clearIndex.store(ring->writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
 	}
 }
 
-
-void Profiler::TimerGetTime(const QString& timerName, const char* sourceFile, const char* func, unsigned int line)
+QJsonObject Profiler::getChromeTrace()
 {
-	std::map<QString,StopWatchItem>::iterator ret = GlobalProfilerMap.find(timerName);
-	Profiler::initLogger();
-	if (ret != GlobalProfilerMap.end())
+	std::vector<std::shared_ptr<Ring>> rings;
 	{
-		_logger->Message(Logger::DEBUG, sourceFile, func, line, "timer '%s' started at %s:%d:%s() took %f s execution time until here", QSTRING_CSTR(timerName),
-		                 FileUtils::getBaseName(ret->second.sourceFile).toLocal8Bit().constData(), ret->second.line, ret->second.func, getClockDelta(ret->second.startTime));
+		QMutexLocker lock(&registryMutex);
+		rings = registry;
 	}
-	else
+
+	QJsonArray traceEvents;
+	std::vector<TraceEvent> events;
+	for (const auto& ring : rings)
 	{
-		_logger->Message(Logger::DEBUG, sourceFile, func, line, "ERROR timer '%s' not started", QSTRING_CSTR(timerName));
+		QJsonObject threadName;
+		threadName["name"] = "thread_name";
+		threadName["ph"] = "M";
+		threadName["pid"] = 1;
+		threadName["tid"] = ring->tid;
+		threadName["args"] = QJsonObject { { "name", ring->threadName } };
+		traceEvents.append(threadName);
+
+		// copy the ring while the owner keeps writing, afterwards drop the slots which may have been overwritten meanwhile
+		const quint64 end = ring->writeIndex.load(std::memory_order_acquire);
+		quint64 begin = qMax(ring->clearIndex.load(std::memory_order_relaxed), end > RING_CAPACITY ? end - RING_CAPACITY : 0);
+
+		events.clear();
+		for (quint64 i = begin; i < end; ++i)
+		{
+			events.push_back(ring->events[i % RING_CAPACITY]);
+		}
+
+		const quint64 written = ring->writeIndex.load(std::memory_order_acquire);
+		const quint64 valid = written >= RING_CAPACITY ? written - RING_CAPACITY + 1 : 0;
+
+		for (quint64 i = qMax(begin, valid); i < end; ++i)
+		{
+			const TraceEvent& event = events[i - begin];
+			QJsonObject item;
+			item["name"] = event.name;
+			item["cat"] = "hyperion";
+			item["ph"] = "X";
+			item["ts"] = static_cast<double>(event.start);
+			item["dur"] = static_cast<double>(event.duration);
+			item["pid"] = 1;
+			item["tid"] = ring->tid;
+			traceEvents.append(item);
+		}
 	}
+
+	QJsonObject trace;
+	trace["traceEvents"] = traceEvents;
+	trace["displayTimeUnit"] = "ms";
+	return trace;
 }
@@ -8,6 +8,8 @@
 #include "WebSocketClient.h"
 #include "WebJsonRpc.h"
 
+#include <hyperion/AuthManager.h>
+
 #include <QCryptographicHash>
 #include <QTcpSocket>
 #include <QStringBuilder>
@@ -206,6 +208,19 @@ void QtHttpClientWrapper::onClientDataReceived (void)
 						}
 					}
 
+					// the metrics are part of the web API, they need the same authorization as json-rpc
+					const QStringList uri_parts = QStringUtils::split(m_currentRequest->getUrl ().path (),'/', QStringUtils::SplitBehavior::SkipEmptyParts);
+					if ( ! uri_parts.empty() && uri_parts.at(0) == "metrics" && ! isApiAuthorized ())
+					{
+						QtHttpReply reply (m_serverHandle);
+						reply.setStatusCode (QtHttpReply::Forbidden);
+						reply.appendRawData (QByteArrayLiteral ("<h1>No Authorization</h1>"));
+						reply.appendRawData (CRLF);
+						m_parsingStatus = sendReplyToClient (&reply);
+
+						break;
+					}
+
 					QtHttpReply reply (m_serverHandle);
 					connect (&reply, &QtHttpReply::requestSendHeaders, this, &QtHttpClientWrapper::onReplySendHeadersRequested);
 					connect (&reply, &QtHttpReply::requestSendData, this, &QtHttpClientWrapper::onReplySendDataRequested);
@@ -305,6 +320,32 @@ void QtHttpClientWrapper::sendToClientWithReply(QtHttpReply * reply)
 	m_parsingStatus = sendReplyToClient (reply);
 }
 
+bool QtHttpClientWrapper::isApiAuthorized (void)
+{
+	AuthManager* authManager = AuthManager::getInstance();
+
+	// without required authorization every request is accepted, like json-rpc requests
+	if ( ! authManager->isAuthRequired())
+	{
+		return true;
+	}
+
+	// local connections are authorized by the settings, like in API::init()
+	if (m_localConnection && ( ! authManager->isLocalAdminAuthRequired() || ! authManager->isLocalAuthRequired()))
+	{
+		return true;
+	}
+
+	// otherwise by a token in the http Authorization header, "token <token>"
+	const QString token = QString::fromUtf8(m_currentRequest->getHeader(QtHttpHeader::Authorization)).mid(5).trimmed();
+	bool authorized = false;
+	(authManager->thread() != this->thread())
+	? QMetaObject::invokeMethod(authManager, "isTokenAuthorized", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, authorized), Q_ARG(QString, token))
+	: authorized = authManager->isTokenAuthorized(token);
+
+	return authorized;
+}
+
 QtHttpClientWrapper::ParsingStatus QtHttpClientWrapper::sendReplyToClient (QtHttpReply * reply)
 {
 	if (reply != Q_NULLPTR)
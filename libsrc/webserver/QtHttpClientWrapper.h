@@ -45,6 +45,12 @@ private slots:
 protected:
 	ParsingStatus sendReplyToClient (QtHttpReply * reply);
 
+	///
+	/// @brief Check the authorization of the current request for the web API, as json-rpc does
+	/// @return True if authorization is not required, the connection is authorized by the settings or the request carries a valid token
+	///
+	bool isApiAuthorized (void);
+
 protected slots:
 	void onReplySendHeadersRequested (void);
 	void onReplySendDataRequested    (void);
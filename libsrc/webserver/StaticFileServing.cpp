@@ -1,6 +1,7 @@
 
 #include "StaticFileServing.h"
 #include <utils/QStringUtils.h>
+#include <utils/LatencyTracer.h>
 
 #include <QStringBuilder>
 #include <QUrlQuery>
@@ -106,6 +107,13 @@ void StaticFileServing::onRequestNeedsReply (QtHttpRequest * request, QtHttpRepl
 				reply->appendRawData (_ssdpDescription);
 				return;
 			}
+			else if(uri_parts.at(0) == "metrics")
+			{
+				// frame pipeline latency in the Prometheus text format
+				reply->addHeader ("Content-Type", "text/plain; version=0.0.4");
+				reply->appendRawData (LatencyTracer::getPrometheusText().toUtf8());
+				return;
+			}
 		}
 
 		QFileInfo info(_baseUrl % "/" % path);
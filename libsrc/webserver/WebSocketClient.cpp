@@ -25,6 +25,7 @@ WebSocketClient::WebSocketClient(QtHttpRequest* request, QTcpSocket* sock, bool
 	// Json processor
 	_jsonAPI = new JsonAPI(client, _log, localConnection, this);
 	connect(_jsonAPI, &JsonAPI::callbackMessage, this, &WebSocketClient::sendMessage);
+	connect(_jsonAPI, &JsonAPI::callbackBinaryMessage, this, &WebSocketClient::sendBinaryMessage);
 	connect(_jsonAPI, &JsonAPI::forceClose, this,[this]() { this->sendClose(CLOSECODE::NORMAL); });
 
 	Debug(_log, "New connection from %s", QSTRING_CSTR(client));
@@ -270,6 +271,16 @@ qint64 WebSocketClient::sendMessage(QJsonObject obj)
 	QJsonDocument writer(obj);
 	QByteArray data = writer.toJson(QJsonDocument::Compact) + "\n";
 
+	return sendFrames(OPCODE::TEXT, data);
+}
+
+qint64 WebSocketClient::sendBinaryMessage(const QByteArray& data)
+{
+	return sendFrames(OPCODE::BINARY, data);
+}
+
+qint64 WebSocketClient::sendFrames(quint8 opCode, const QByteArray& data)
+{
 	if (!_socket || (_socket->state() != QAbstractSocket::ConnectedState)) return 0;
 
 	qint64 payloadWritten = 0;
@@ -285,7 +296,7 @@ qint64 WebSocketClient::sendMessage(QJsonObject obj)
 		quint64 position  = i * FRAME_SIZE_IN_BYTES;
 		quint32 frameSize = (payloadSize-position >= FRAME_SIZE_IN_BYTES) ? FRAME_SIZE_IN_BYTES : (payloadSize-position);
 
-		QByteArray buf = makeFrameHeader((i == 0) ? OPCODE::TEXT : OPCODE::CONTINUATION, frameSize, isLastFrame);
+		QByteArray buf = makeFrameHeader((i == 0) ? opCode : OPCODE::CONTINUATION, frameSize, isLastFrame);
 		sendMessage_Raw(buf);
 
 		qint64 written = sendMessage_Raw(payload+position,frameSize);
@@ -49,6 +49,7 @@ int main(int argc, char ** argv)
 		Option        & argAddress    = parser.add<Option>       ('a', "address",    "Set the address of the hyperion server [default: %1]", "127.0.0.1:19400");
 		IntOption     & argPriority   = parser.add<IntOption>    ('p', "priority",   "Use the provided priority channel (suggested 100-199) [default: %1]", "150");
 		BooleanOption & argSkipReply  = parser.add<BooleanOption>(0x0, "skip-reply", "Do not receive and check reply messages from Hyperion");
+		Option        & argEncoding   = parser.add<Option>       (0x0, "encoding", "Image encoding, raw images are sent if the server does not support it (raw, nv12, lz4, jpeg) [default: %1]", "lz4");
 		BooleanOption & argDebug      = parser.add<BooleanOption>(0x0, "debug", "Enable debug logging");
 		BooleanOption & argHelp       = parser.add<BooleanOption>('h', "help",       "Show this help message and exit");
 
@@ -91,6 +92,7 @@ int main(int argc, char ** argv)
 
 			// Create the Flabuf-connection
 			FlatBufferConnection flatbuf("AML Standalone", address, argPriority.getInt(parser), parser.isSet(argSkipReply));
+			flatbuf.setImageEncoding(FlatBufferConnection::parseImageEncoding(argEncoding.value(parser)));
 
 			// Connect the screen capturing to flatbuf connection processing
 			QObject::connect(&amlWrapper, SIGNAL(sig_screenshot(const Image<ColorRgb> &)), &flatbuf, SLOT(setImage(Image<ColorRgb>)));
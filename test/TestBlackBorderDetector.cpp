@@ -137,6 +137,49 @@ int TC_UNKNOWN_BORDER()
 	return result;
 }
 
+int TC_FULLSCAN_BORDER()
+{
+	int result = 0;
+
+	BlackBorderDetector detector(0.05);
+
+	{
+		// letterbox and pillarbox, decimated internally and refined at image resolution
+		Image<ColorRgb> image = createImage(1920, 1080, 133, 203);
+		for (unsigned y=0; y<image.height(); ++y)
+		{
+			for (unsigned x=0; x<image.width(); ++x)
+			{
+				if (y >= image.height() - 133 || x >= image.width() - 203)
+				{
+					image(x,y) = ColorRgb::BLACK;
+				}
+			}
+		}
+
+		BlackBorder border = detector.process_fullscan(image);
+		if (border.unknown || border.horizontalSize != 133 || border.verticalSize != 203)
+		{
+			std::cerr << "Failed to correctly detect four-sided border in fullscan mode" << std::endl;
+			result = -1;
+		}
+		else std::cout << "Correctly detected four-sided border in fullscan mode" << std::endl;
+	}
+
+	{
+		Image<ColorRgb> image = createImage(64, 64, 64, 64);
+		BlackBorder border = detector.process_fullscan(image);
+		if (border.unknown != true)
+		{
+			std::cerr << "Failed to correctly detect unknown border in fullscan mode" << std::endl;
+			result = -1;
+		}
+		else std::cout << "Correctly detected unknown border in fullscan mode" << std::endl;
+	}
+
+	return result;
+}
+
 int main()
 {
 	TC_NO_BORDER();
@@ -144,6 +187,7 @@ int main()
 	TC_LEFT_BORDER();
 	TC_DUAL_BORDER();
 	TC_UNKNOWN_BORDER();
+	TC_FULLSCAN_BORDER();
 
 	return 0;
 }
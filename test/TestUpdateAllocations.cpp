@@ -0,0 +1,199 @@
+// STL includes
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <QTimer>
+
+// Hyperion includes
+#include <utils/ColorRgb.h>
+#include <utils/Components.h>
+#include <utils/Image.h>
+#include <utils/settings.h>
+#include <hyperion/Hyperion.h>
+#include <hyperion/HyperionIManager.h>
+#include <hyperion/SettingsManager.h>
+#include <effectengine/EffectFileHandler.h>
+
+// Counts the heap allocations of the thread that enabled it
+static thread_local bool countAllocations = false;
+static std::atomic<long> allocations(0);
+
+void* operator new(std::size_t size)
+{
+	if (countAllocations)
+	{
+		++allocations;
+	}
+	void* ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+const int FRAMES = 100;
+const int START_TIMEOUT_MS = 10000;
+
+///
+/// Starts Hyperion instance 0 with the default configuration in a temporary root path, as the daemon does.
+/// The foreground effect is disabled, it needs Python and would hold the visible priority.
+///
+class HyperionFixture
+{
+public:
+	HyperionFixture()
+		: _manager(_rootDir.path())
+		, _globalSettings(GLOABL_INSTANCE_ID)
+		, _effectFileHandler(_rootDir.path(), _globalSettings.getSetting(settings::EFFECTS))
+		, _hyperion(nullptr)
+	{
+		{
+			SettingsManager instanceSettings(0);
+			QJsonObject config = instanceSettings.getSettings();
+			QJsonObject fgEffect = config[settings::typeToString(settings::FGEFFECT)].toObject();
+			fgEffect["enable"] = false;
+			config[settings::typeToString(settings::FGEFFECT)] = fgEffect;
+			instanceSettings.saveSettings(config, true);
+		}
+
+		if (waitForState(InstanceState::H_STARTED, [this]() { _manager.startInstance(0); }))
+		{
+			_hyperion = _manager.getHyperionInstance(0);
+		}
+	}
+
+	~HyperionFixture()
+	{
+		if (_hyperion != nullptr)
+		{
+			waitForState(InstanceState::H_STOPPED, [this]() { _manager.stopAll(); });
+		}
+	}
+
+	Hyperion* hyperion() const { return _hyperion; }
+
+	///
+	/// Runs the function on the thread of the instance and waits for it
+	///
+	template <typename Func>
+	void runOnInstanceThread(Func func)
+	{
+		QSemaphore done;
+		QTimer::singleShot(0, _hyperion, [&func, &done]() { func(); done.release(); });
+		done.acquire();
+	}
+
+private:
+	template <typename Func>
+	bool waitForState(InstanceState expected, Func trigger)
+	{
+		bool reached = false;
+		QEventLoop loop;
+		QObject::connect(&_manager, &HyperionIManager::instanceStateChanged, &loop, [&](InstanceState state, quint8 instance) {
+			if (instance == 0 && state == expected)
+			{
+				reached = true;
+				loop.quit();
+			}
+		});
+		QTimer::singleShot(START_TIMEOUT_MS, &loop, &QEventLoop::quit);
+		trigger();
+		if (!reached)
+		{
+			loop.exec();
+		}
+		return reached;
+	}
+
+	QTemporaryDir _rootDir;
+	HyperionIManager _manager;
+	SettingsManager _globalSettings;
+	EffectFileHandler _effectFileHandler;
+	Hyperion* _hyperion;
+};
+
+///
+/// Runs the real Hyperion::update on the instance thread. The first frame sizes the buffers, after it the
+/// muxer access, image processing or color copy and the adjustment must not allocate.
+///
+/// The led device is disabled, so the write path is not covered. It still allocates per frame: when the
+/// device thread took the previous frame, updateLeds posts one queued ledValuesPending event. Smoothing
+/// copies into its inbox slots, which only allocate until each slot was filled once.
+/// Each queued receiver of currentImage or rawLedColors (e.g. a json client streaming the leds or the
+/// image) gets a copy of the argument per frame; nothing is connected to them here.
+///
+int TC_UPDATE_WITHOUT_ALLOCATION(HyperionFixture& fixture, bool imageInput)
+{
+	Hyperion* hyperion = fixture.hyperion();
+
+	fixture.runOnInstanceThread([hyperion, imageInput]() {
+		emit hyperion->compStateChangeRequest(hyperion::COMP_LEDDEVICE, false);
+
+		// setting the visible input runs the first update
+		if (imageInput)
+		{
+			hyperion->registerInput(100, hyperion::COMP_V4L);
+			hyperion->setInputImage(100, Image<ColorRgb>(64, 64, ColorRgb{12, 34, 56}));
+		}
+		else
+		{
+			hyperion->setColor(50, std::vector<ColorRgb>(hyperion->getLedCount(), ColorRgb{255, 0, 0}));
+		}
+
+		countAllocations = true;
+		for (int frame = 0; frame < FRAMES; ++frame)
+		{
+			hyperion->update();
+		}
+		countAllocations = false;
+	});
+
+	int result = 0;
+	if (allocations != 0)
+	{
+		std::cerr << "Failed to update without allocation, " << allocations << " allocations in " << FRAMES << " frames" << std::endl;
+		result = -1;
+	}
+	else std::cout << "Correctly updated " << (imageInput ? "image" : "color") << " input without allocation" << std::endl;
+
+	allocations = 0;
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	HyperionFixture fixture;
+	if (fixture.hyperion() == nullptr)
+	{
+		std::cerr << "Failed to start the Hyperion instance" << std::endl;
+		return -1;
+	}
+
+	int result = 0;
+	result |= TC_UPDATE_WITHOUT_ALLOCATION(fixture, true);
+	// the color input takes the higher priority
+	result |= TC_UPDATE_WITHOUT_ALLOCATION(fixture, false);
+
+	return result;
+}